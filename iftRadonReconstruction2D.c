@@ -0,0 +1,121 @@
+#include "ift.h"
+#include "iftRadon.h"
+#include "iftRadonEM.h"
+#include "iftRadonReconstruction.h"
+#include "iftRadonStats.h"
+#include "iftRadonWriter.h"
+
+
+/* root mean squared error of a reconstruction with respect to the original image */
+static double iftRadonReconstructionRMSE(const iftFImage *rec, const iftImage *img)
+{
+    double sum = 0;
+    for (int p = 0; p < img->n; p++)
+        sum += (rec->val[p] - img->val[p]) * (rec->val[p] - img->val[p]);
+
+    return sqrt(sum / img->n);
+}
+
+
+/* prints the time and the quality of a reconstruction, and queues it for writing */
+static void iftRadonReportReconstruction(const char *method, iftFImage *rec, double ms, const iftImage *img,
+                                         const char *imgFileName, iftRadonWriter *writer)
+{
+    int max_val = iftMaximumValue(img), min_val = iftMinimumValue(img);
+    double rmse = iftRadonReconstructionRMSE(rec, img);
+    double psnr = (rmse > 0) ? 20 * log10((max_val - min_val) / rmse) : INFINITY;
+
+    printf("%-24s %10.2f ms   RMSE %10.3f   PSNR %6.2f dB\n", method, ms, rmse, psnr);
+
+    if (iftRadonWriterVisualization(writer)) {
+        double tic = iftRadonStatsTic();
+        iftImage *out = iftCreateImage(rec->xsize, rec->ysize, 1);
+        for (int p = 0; p < out->n; p++)
+            out->val[p] = iftRound(iftMax(iftMin(rec->val[p], max_val), min_val));
+        iftImage *normalizedImage = iftNormalize(out, 0, 255);
+        iftDestroyImage(&out);
+        iftRadonStatsToc(IFT_RADON_STAGE_NORMALIZATION, tic);
+
+        char fileName[256];
+        sprintf(fileName, "%s_%s.png", method, iftFilename(imgFileName, iftFileExt(imgFileName)));
+        iftRadonWriterPushImage(writer, normalizedImage, fileName);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    iftParseRadonStatsOptions(&argc, argv);
+    iftRadonWriter *writer = iftParseRadonWriterOptions(&argc, argv);
+
+    /* accuracy of the hierarchical back-projection, and iterations and subsets of OS-EM */
+    double accuracy = IFT_RADON_HIERARCHICAL_ACCURACY;
+    int niters = IFT_RADON_EM_ITERATIONS, nsubsets = IFT_RADON_EM_SUBSETS;
+    int n = 1;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-a") == 0) && (i + 1 < argc))
+            accuracy = atof(argv[++i]);
+        else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc))
+            niters = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            nsubsets = atoi(argv[++i]);
+        else
+            argv[n++] = argv[i];
+    }
+    argc = n;
+
+    if (argc != 2)
+        iftError("Usage: iftRadonReconstruction2D <input-image.png> [-v <verbosity>] [-o <stats.json|stats.csv>] "
+                 "[-j <encoder-threads>] [-q <queue-capacity>] [-n] [-a <accuracy>] [-i <em-iterations>] [-s <em-subsets>]",
+                 "main");
+
+    char *imgFileName = iftCopyString(argv[1]);
+    double tic = iftRadonStatsTic();
+    iftImage *img = iftReadImageByExt(imgFileName);
+    iftRadonStatsToc(IFT_RADON_STAGE_DECODE, tic);
+
+    /* the reconstructions and the EM projectors assume the ray-driven geometry and sampling density */
+    timer *t1 = iftTic();
+    iftImage *R = iftFastRadonTransform(img);
+    printf("Time to compute the Radon Transform: %s\n", iftFormattedTime(iftCompTime(t1, iftToc())));
+    printf("Image %d x %d, sinogram %d x %d\n", img->xsize, img->ysize, R->xsize, R->ysize);
+
+    /* the O(N^3) filtered back-projection is the reference of the O(N^2 log N) methods */
+    t1 = iftTic();
+    iftFImage *fbp = iftRadonFilteredBackProjection(R, img->xsize, img->ysize);
+    iftRadonReportReconstruction("fbp", fbp, iftCompTime(t1, iftToc()), img, imgFileName, writer);
+
+    t1 = iftTic();
+    iftFImage *hierarchical = iftRadonHierarchicalBackProjection(R, img->xsize, img->ysize, accuracy);
+    iftRadonReportReconstruction("hierarchical", hierarchical, iftCompTime(t1, iftToc()), img, imgFileName, writer);
+
+    t1 = iftTic();
+    iftFImage *gridding = iftRadonGriddingReconstruction(R, img->xsize, img->ysize);
+    iftRadonReportReconstruction("gridding", gridding, iftCompTime(t1, iftToc()), img, imgFileName, writer);
+
+    /* the sensitivity images are computed once per geometry, outside the timing of the reconstruction */
+    t1 = iftTic();
+    iftRadonEM *em = iftCreateRadonEM(img->xsize, img->ysize, nsubsets);
+    printf("Time to create the EM geometry (%d subsets): %s\n", nsubsets,
+           iftFormattedTime(iftCompTime(t1, iftToc())));
+    t1 = iftTic();
+    iftFImage *osem = iftRadonEMReconstruction(em, R, niters);
+    iftRadonReportReconstruction((nsubsets == 1) ? "mlem" : "osem", osem, iftCompTime(t1, iftToc()), img,
+                                 imgFileName, writer);
+    printf("%-24s %10.2f ms per subset update (%d updates)\n", "", iftRadonEMMeanUpdateTime(em),
+           niters * nsubsets);
+
+    iftDestroyRadonWriter(&writer);
+    iftFinishRadonStats();
+
+    iftDestroyFImage(&fbp);
+    iftDestroyFImage(&hierarchical);
+    iftDestroyFImage(&gridding);
+    iftDestroyFImage(&osem);
+    iftDestroyRadonEM(&em);
+    iftDestroyImage(&R);
+    iftDestroyImage(&img);
+    iftFree(imgFileName);
+
+    return(0);
+}
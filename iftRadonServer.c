@@ -0,0 +1,377 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "ift.h"
+#include "iftRadonPlan.h"
+#include "iftRadonServer.h"
+
+/* maximum number of connected clients (and of requests in a batch) */
+#define IFT_RADON_SERVER_MAX_CLIENTS 64
+/* plans kept between batches: at most IFT_RADON_SERVER_MAX_CLIENTS, with at most this many rays
+   (IFT_RADON_NANGLES * nbins per plan, about 100 MB) */
+#define IFT_RADON_SERVER_MAX_CACHED_RAYS (1L << 22)
+/* plans during a batch: the cached ones and one per request */
+#define IFT_RADON_SERVER_MAX_PLANS (2 * IFT_RADON_SERVER_MAX_CLIENTS)
+
+
+/* plan of one geometry, shared by every request of that size */
+typedef struct {
+    int xsize, ysize;
+    iftRadonPlan *plan;
+    /* last batch that used the plan */
+    long last_used;
+} iftRadonServerPlan;
+
+/* connection of a client and the part of its next request received so far */
+typedef struct {
+    int fd;
+    iftRadonRequest req;
+    size_t got;
+} iftRadonServerClient;
+
+typedef struct {
+    int fd;
+    iftRadonRequest req;
+    iftRadonReply reply;
+    iftRadonServerPlan *plan;
+    /* first job of the batch with the same plan: the jobs of a plan run one after the other */
+    int owner;
+    timer *arrival;
+} iftRadonServerJob;
+
+
+static volatile sig_atomic_t running = 1;
+
+static void iftRadonServerStop(int sig)
+{
+    (void) sig;
+    running = 0;
+}
+
+
+/*
+ * Reads what has arrived of the pending request of a non-blocking client. Returns 1 when the request is
+ * complete, 0 when more bytes are due, and -1 when the client closed the connection or failed.
+ */
+static int iftRadonServerRecv(iftRadonServerClient *client)
+{
+    while (client->got < sizeof(iftRadonRequest)) {
+        ssize_t r = recv(client->fd, (char *) &client->req + client->got, sizeof(iftRadonRequest) - client->got, 0);
+        if (r > 0)
+            client->got += r;
+        else if ((r < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+            return 0;
+        else if ((r < 0) && (errno == EINTR))
+            continue;
+        else
+            return -1;
+    }
+    client->got = 0;
+    return 1;
+}
+
+
+/*
+ * Sends a reply to a non-blocking client. The replies are a few dozen bytes, so they only block when the
+ * client stopped reading them: it then returns false, and the client is dropped instead of stalling the others.
+ */
+static bool iftRadonServerSend(int fd, const void *buf, size_t n)
+{
+    size_t sent = 0;
+    while (sent < n) {
+        ssize_t r = send(fd, (const char *) buf + sent, n - sent, 0);
+        if (r > 0)
+            sent += r;
+        else if ((r < 0) && (errno == EINTR))
+            continue;
+        else
+            return false;
+    }
+    return true;
+}
+
+
+/* maps a client shared memory object of at least size bytes, or returns NULL with the failure status */
+static void *iftRadonServerMapShm(const char *name, size_t size, int prot, int *status)
+{
+    int fd = shm_open(name, (prot & PROT_WRITE) ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        *status = IFT_RADON_STATUS_SHM_ERROR;
+        return NULL;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || ((size_t) st.st_size < size)) {
+        *status = IFT_RADON_STATUS_SHM_TOO_SMALL;
+        close(fd);
+        return NULL;
+    }
+
+    void *ptr = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        *status = IFT_RADON_STATUS_SHM_ERROR;
+        return NULL;
+    }
+
+    return ptr;
+}
+
+
+/* plan of a geometry, created on its first request */
+static iftRadonServerPlan *iftRadonServerGetPlan(iftRadonServerPlan *plans, int *nplans, int xsize, int ysize, long batch)
+{
+    for (int i = 0; i < *nplans; i++)
+        if ((plans[i].xsize == xsize) && (plans[i].ysize == ysize)) {
+            plans[i].last_used = batch;
+            return &plans[i];
+        }
+
+    iftRadonServerPlan *plan = &plans[(*nplans)++];
+    plan->xsize     = xsize;
+    plan->ysize     = ysize;
+    plan->plan      = iftCreateRadonPlan(xsize, ysize);
+    plan->last_used = batch;
+
+    return plan;
+}
+
+
+/* destroys the least recently used plans until at most IFT_RADON_SERVER_MAX_CLIENTS plans remain, holding at
+   most IFT_RADON_SERVER_MAX_CACHED_RAYS rays (or a single plan) */
+static void iftRadonServerEvictPlans(iftRadonServerPlan *plans, int *nplans)
+{
+    long nrays = 0;
+    for (int i = 0; i < *nplans; i++)
+        nrays += (long) iftRadonPlanOutputSize(plans[i].plan);
+
+    while ((*nplans > IFT_RADON_SERVER_MAX_CLIENTS) || ((*nplans > 1) && (nrays > IFT_RADON_SERVER_MAX_CACHED_RAYS))) {
+        int lru = 0;
+        for (int i = 1; i < *nplans; i++)
+            if (plans[i].last_used < plans[lru].last_used)
+                lru = i;
+        nrays -= (long) iftRadonPlanOutputSize(plans[lru].plan);
+        iftDestroyRadonPlan(&plans[lru].plan);
+        plans[lru] = plans[--(*nplans)];
+    }
+}
+
+
+/* executes the plan of the job directly on the shared memory objects of the client */
+static void iftRadonServerTransform(iftRadonServerJob *job)
+{
+    const iftRadonPlan *plan = job->plan->plan;
+    size_t in_size  = (size_t) job->req.xsize * job->req.ysize * sizeof(int32_t);
+    size_t out_size = iftRadonPlanOutputSize(plan) * sizeof(int32_t);
+    int status = IFT_RADON_STATUS_OK;
+
+    job->reply.nangles = IFT_RADON_NANGLES;
+    job->reply.nbins   = iftRadonPlanNumberOfBins(plan);
+
+    int32_t *in = iftRadonServerMapShm(job->req.in_shm, in_size, PROT_READ, &status);
+    if (in == NULL) {
+        job->reply.status = status;
+        return;
+    }
+    int32_t *out = iftRadonServerMapShm(job->req.out_shm, out_size, PROT_READ | PROT_WRITE, &status);
+    if (out == NULL) {
+        munmap(in, in_size);
+        job->reply.status = status;
+        return;
+    }
+
+    iftExecuteRadonPlan(plan, in, out);
+
+    munmap(in, in_size);
+    munmap(out, out_size);
+    job->reply.status = IFT_RADON_STATUS_OK;
+}
+
+
+static bool iftRadonServerIsValidRequest(const iftRadonRequest *req)
+{
+    return (req->magic == IFT_RADON_SERVER_MAGIC) &&
+           ((req->op == IFT_RADON_OP_STATS) ||
+            ((req->op == IFT_RADON_OP_TRANSFORM) && (req->xsize > 0) && (req->ysize > 0) &&
+             (req->xsize <= IFT_RADON_SERVER_MAX_SIDE) && (req->ysize <= IFT_RADON_SERVER_MAX_SIDE) &&
+             ((size_t) req->xsize * (size_t) req->ysize <= IFT_RADON_SERVER_MAX_PIXELS) &&
+             (memchr(req->in_shm, '\0', IFT_RADON_SHM_NAME_LEN) != NULL) &&
+             (memchr(req->out_shm, '\0', IFT_RADON_SHM_NAME_LEN) != NULL)));
+}
+
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+        iftError("Usage: iftRadonServer <socket-path>", "main");
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(argv[1]) >= sizeof(addr.sun_path))
+        iftError("Socket path too long: %s", "main", argv[1]);
+    strcpy(addr.sun_path, argv[1]);
+    unlink(argv[1]);
+    if ((server < 0) || (bind(server, (struct sockaddr *) &addr, sizeof(addr)) != 0) ||
+        (listen(server, IFT_RADON_SERVER_MAX_CLIENTS) != 0))
+        iftError("Cannot listen on %s", "main", argv[1]);
+
+    signal(SIGINT, iftRadonServerStop);
+    signal(SIGTERM, iftRadonServerStop);
+    signal(SIGPIPE, SIG_IGN);
+    printf("Radon server listening on %s\n", argv[1]);
+    fflush(stdout);
+
+    struct pollfd fds[IFT_RADON_SERVER_MAX_CLIENTS + 1];
+    iftRadonServerClient clients[IFT_RADON_SERVER_MAX_CLIENTS + 1];
+    int nclients = 0;
+    iftRadonServerPlan plans[IFT_RADON_SERVER_MAX_PLANS];
+    int nplans = 0;
+    iftRadonServerJob jobs[IFT_RADON_SERVER_MAX_CLIENTS];
+    iftRadonServerStats stats;
+    memset(&stats, 0, sizeof(stats));
+    long batch = 0;
+    int nthreads = omp_get_max_threads();
+
+    while (running) {
+        fds[0].fd = server;
+        fds[0].events = POLLIN;
+        for (int c = 1; c <= nclients; c++) {
+            fds[c].fd = clients[c].fd;
+            fds[c].events = POLLIN;
+        }
+
+        if (poll(fds, nclients + 1, -1) <= 0)
+            continue;
+
+        /* every request completed by the bytes that arrived together forms a batch */
+        int njobs = 0;
+        batch++;
+        for (int c = nclients; c >= 1; c--) {
+            if (!(fds[c].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            int complete = iftRadonServerRecv(&clients[c]);
+            if (complete < 0) {
+                close(clients[c].fd);
+                clients[c] = clients[nclients--];
+                continue;
+            }
+            if (complete == 0)
+                continue;
+
+            iftRadonServerJob *job = &jobs[njobs];
+            job->req     = clients[c].req;
+            job->fd      = clients[c].fd;
+            job->arrival = iftTic();
+            memset(&job->reply, 0, sizeof(iftRadonReply));
+            job->reply.magic = IFT_RADON_SERVER_MAGIC;
+            job->plan  = NULL;
+            job->owner = njobs;
+
+            if (!iftRadonServerIsValidRequest(&job->req))
+                job->reply.status = IFT_RADON_STATUS_BAD_REQUEST;
+            else if (job->req.op == IFT_RADON_OP_TRANSFORM) {
+                job->plan = iftRadonServerGetPlan(plans, &nplans, job->req.xsize, job->req.ysize, batch);
+                for (int j = 0; j < njobs; j++)
+                    if (jobs[j].plan == job->plan) {
+                        job->owner = j;
+                        break;
+                    }
+            }
+            njobs++;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int client = accept(server, NULL, NULL);
+            if (client >= 0) {
+                if ((nclients < IFT_RADON_SERVER_MAX_CLIENTS) &&
+                    (fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK) == 0)) {
+                    nclients++;
+                    clients[nclients].fd  = client;
+                    clients[nclients].got = 0;
+                } else
+                    close(client);
+            }
+        }
+
+        if (njobs == 0)
+            continue;
+
+        /*
+         * One task per plan. A single plan gets all the threads for its executions; otherwise the plans run in
+         * parallel, one thread each. The plans are not shared by concurrent tasks, so their threads can be set.
+         */
+        int ntasks = 0;
+        for (int j = 0; j < njobs; j++)
+            ntasks += (jobs[j].plan != NULL) && (jobs[j].owner == j);
+        for (int j = 0; j < njobs; j++)
+            if ((jobs[j].plan != NULL) && (jobs[j].owner == j))
+                iftSetRadonPlanNumberOfThreads(jobs[j].plan->plan, (ntasks == 1) ? nthreads : 1);
+
+        #pragma omp parallel for schedule(dynamic) if (ntasks > 1)
+        for (int j = 0; j < njobs; j++)
+            if ((jobs[j].plan != NULL) && (jobs[j].owner == j))
+                for (int k = j; k < njobs; k++)
+                    if ((jobs[k].plan != NULL) && (jobs[k].owner == j))
+                        iftRadonServerTransform(&jobs[k]);
+
+        stats.nbatches++;
+        stats.mean_batch_size += (njobs - stats.mean_batch_size) / stats.nbatches;
+
+        for (int j = 0; j < njobs; j++) {
+            iftRadonServerJob *job = &jobs[j];
+            job->reply.elapsed_ms = iftCompTime(job->arrival, iftToc());
+
+            bool sent;
+            if ((job->reply.status == IFT_RADON_STATUS_OK) && (job->req.op == IFT_RADON_OP_STATS)) {
+                stats.nplans = nplans;
+                sent = iftRadonServerSend(job->fd, &job->reply, sizeof(iftRadonReply)) &&
+                       iftRadonServerSend(job->fd, &stats, sizeof(iftRadonServerStats));
+            } else {
+                stats.nrequests++;
+                if (job->reply.status != IFT_RADON_STATUS_OK)
+                    stats.nerrors++;
+                else {
+                    uint64_t nok = stats.nrequests - stats.nerrors;
+                    stats.last_ms  = job->reply.elapsed_ms;
+                    stats.min_ms   = (nok == 1) ? stats.last_ms : iftMin(stats.min_ms, stats.last_ms);
+                    stats.max_ms   = iftMax(stats.max_ms, stats.last_ms);
+                    stats.mean_ms += (stats.last_ms - stats.mean_ms) / nok;
+                }
+                sent = iftRadonServerSend(job->fd, &job->reply, sizeof(iftRadonReply));
+            }
+
+            /* a client that does not read its replies is dropped */
+            if (!sent)
+                for (int c = 1; c <= nclients; c++)
+                    if (clients[c].fd == job->fd) {
+                        close(clients[c].fd);
+                        clients[c] = clients[nclients--];
+                        break;
+                    }
+        }
+
+        iftRadonServerEvictPlans(plans, &nplans);
+    }
+
+    printf("Requests: %lu (%lu errors), batches: %lu (%.2f requests/batch)\n", (ulong) stats.nrequests,
+           (ulong) stats.nerrors, (ulong) stats.nbatches, stats.mean_batch_size);
+    printf("Latency (ms): mean %.3f, min %.3f, max %.3f\n", stats.mean_ms, stats.min_ms, stats.max_ms);
+
+    for (int c = 1; c <= nclients; c++)
+        close(clients[c].fd);
+    close(server);
+    unlink(argv[1]);
+    for (int i = 0; i < nplans; i++)
+        iftDestroyRadonPlan(&plans[i].plan);
+
+    return(0);
+}
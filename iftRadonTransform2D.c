@@ -1,110 +1,59 @@
 #include "ift.h"
-
-iftMatrix *createRadonMatrix(iftImage *img, int theta)
-{
-    iftMatrix *resMatrix = NULL;
-
-    iftVector v1 = {.x = -((float)img->xsize / 2.0), .y = -((float)img->ysize / 2.0), .z = 0.0};
-    iftMatrix *transMatrix1 = iftTranslationMatrix(v1);
-
-    iftMatrix *rotMatrix = iftRotationMatrix(IFT_AXIS_Z, theta);
-
-    float D = sqrt(img->xsize*img->xsize + img->ysize*img->ysize);
-    iftVector v2 = {.x = (D / 2.0), .y = (D / 2.0), .z = 0.0};
-    iftMatrix *transMatrix2 = iftTranslationMatrix(v2);
-
-    resMatrix = iftMultMatricesChain(3, transMatrix2, rotMatrix, transMatrix1);
-
-    return resMatrix;
-}
-
-iftMatrix *imagePixelToMatrix(iftImage *img, int p)
-{
-    iftMatrix *pixMat = iftCreateMatrix(1, 4);
-    iftMatrixElem(pixMat, 0, 0) = p % img->xsize;
-    iftMatrixElem(pixMat, 0, 1) = p / img->xsize;
-    iftMatrixElem(pixMat, 0, 2) = 0;
-    iftMatrixElem(pixMat, 0, 3) = 1;
-
-    return pixMat;
-}
-
-iftImage *radonTransform(iftImage *img)
-{
-    float D = sqrt(img->xsize*img->xsize + img->ysize*img->ysize);
-    iftImage *R = iftCreateImage(180, D, 1);
-
-    int progress = 0;
-#pragma omp parallel for shared(progress)
-    for(int theta = 0; theta < 180; theta++) {
-        fprintf(stdout, "Progress: %.1f %s\r", (progress/180.0*100.0), "%"); fflush(stdout);
-
-        /* compute the translated/rotated image (pixel-wise) */
-        iftMatrix *M = createRadonMatrix(img, -theta);
-        iftImage *imgQ = iftCreateImage(D, D, 1);
-        for(int p = 0; p < img->n; p++) {
-            iftMatrix *Ip = imagePixelToMatrix(img, p);
-            iftMatrix *Iq = iftMultMatrices(M, Ip);
-            int x = (int)iftMatrixElem(Iq, 0, 0);
-            int y = (int)iftMatrixElem(Iq, 0, 1);
-            iftImgVal2D(imgQ, x, y) = img->val[p];
-            iftDestroyMatrix(&Ip);
-            iftDestroyMatrix(&Iq);
-        }
-
-        /* apply the Radon transform */
-        for(int rho = 0; rho < D; rho++) {
-            int xq = rho;
-            for(int yq = 0; yq < D; yq++)
-                iftImgVal2D(R, theta, rho) += iftImgVal2D(imgQ, xq, yq);
-        }
-
-        iftDestroyMatrix(&M);
-        iftDestroyImage(&imgQ);
-        progress++;
-    }
-    fprintf(stdout, "\n"); fflush(stdout);
-
-    return R;
-}
+#include "iftRadon.h"
+#include "iftRadonStats.h"
+#include "iftRadonColormap.h"
+#include "iftRadonWriter.h"
 
 int main(int argc, char *argv[])
 {
+    iftParseRadonStatsOptions(&argc, argv);
+    iftRadonWriter *writer = iftParseRadonWriterOptions(&argc, argv);
     if (argc != 2)
-        iftError("Usage: Reconstruction <input-image.png>","main");
+        iftError("Usage: Reconstruction <input-image.png> [-v <verbosity>] [-o <stats.json|stats.csv>] "
+                 "[-j <encoder-threads>] [-q <queue-capacity>] [-n]","main");
 
     timer *t1 = iftTic();
     char *imgFileName = iftCopyString(argv[1]);
 
     /* compute the Radon transform */
+    double tic = iftRadonStatsTic();
     iftImage *img = iftReadImageByExt(imgFileName);
-    iftImage *imgRadon = radonTransform(img);
-    iftImage *imgRadonNorm = iftNormalize(imgRadon, 0.0, 255.0); // normalize only to apply the color table
+    iftRadonStatsToc(IFT_RADON_STAGE_DECODE, tic);
+    long nallocs = iftRadonStatsCounter(IFT_RADON_COUNTER_ALLOCS);
+    iftImage *imgRadon = iftRotationRadonTransform(img);
+    nallocs = iftRadonStatsCounter(IFT_RADON_COUNTER_ALLOCS) - nallocs;
     printf("Time to compute the Radon Transform: %s\n", iftFormattedTime(iftCompTime(t1, iftToc())));
+    /* heap allocations of the projector (its scratch arenas and buffers), counted when the statistics are on */
+    if (ift_radon_stats_verbosity > 0)
+        printf("Heap allocations of the Radon Transform: %ld\n", nallocs);
 
-    /* create a color table for the resulting image */
-    iftImage *imgRadonColTab = iftCreateColorImage(imgRadon->xsize, imgRadon->ysize, 1, 8);
-    iftColorTable *ctb = iftCreateHotIronColorTable(256);
-    for(int p=0; p < imgRadon->n; p++) {
-        iftColor YCbCr = iftRGBtoYCbCr(ctb->color[imgRadonNorm->val[p]], 255);
-        imgRadonColTab->val[p] = YCbCr.val[0];
-        imgRadonColTab->Cb[p] = YCbCr.val[1];
-        imgRadonColTab->Cr[p] = YCbCr.val[2];
-    }
-
-    /* save the resulting images */
+    /* save the resulting images: the writer destroys them once written */
     char fileName[256];
+    int nangles = imgRadon->xsize, nbins = imgRadon->ysize;
+    iftImage *imgRadonNorm = NULL;
+    if (iftRadonWriterVisualization(writer)) {
+        tic = iftRadonStatsTic();
+        imgRadonNorm = iftNormalize(imgRadon, 0.0, 255.0); // normalize only to apply the color table
+        iftRadonStatsToc(IFT_RADON_STAGE_NORMALIZATION, tic);
+    }
     sprintf(fileName, "radon_transform_%s.png", iftFilename(imgFileName, iftFileExt(imgFileName)));
-    iftWriteImageByExt(imgRadon, fileName);
-
-    sprintf(fileName, "radon_transform_%s_colortable.png", iftFilename(imgFileName, iftFileExt(imgFileName)));
-    iftWriteImageByExt(imgRadonColTab, fileName);
+    iftRadonWriterPushImage(writer, imgRadon, fileName);
+
+    /* color the resulting image while the sinogram is written */
+    if (imgRadonNorm != NULL) {
+        tic = iftRadonStatsTic();
+        iftRadonColormap cmap = iftRadonHotIronColormap();
+        uchar *imgRadonRGB = iftRadonApplyColormap(imgRadonNorm, &cmap);
+        iftRadonStatsToc(IFT_RADON_STAGE_COLORMAP, tic);
+        iftDestroyImage(&imgRadonNorm);
+
+        sprintf(fileName, "radon_transform_%s_colortable.png", iftFilename(imgFileName, iftFileExt(imgFileName)));
+        iftRadonWriterPushRGB(writer, imgRadonRGB, nangles, nbins, fileName);
+    }
+    iftDestroyRadonWriter(&writer);
+    iftFinishRadonStats();
 
     iftDestroyImage(&img);
-    iftDestroyImage(&imgRadon);
-    iftDestroyImage(&imgRadonNorm);
-    iftDestroyImage(&imgRadonColTab);
-    iftDestroyColorTable(&ctb);
 
     return(0);
 }
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Scratch-buffer arena for the transient buffers of the Radon projectors.
+ *
+ * An arena hands out zeroed blocks carved from one large buffer (obtained with iftAlloc())
+ * and releases all of them at once with iftResetArena(). When a cycle (e.g. one projection
+ * angle) needs more memory than the arena holds, the extra blocks come from overflow chunks,
+ * and the next reset merges everything into a single buffer of the peak size. After the
+ * first cycle the arena therefore serves every request without touching the heap.
+ *
+ * Arenas are not thread-safe: each thread must own its arena.
+ */
+
+#ifndef IFT_ARENA_H
+#define IFT_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftImage.h"
+#include "iftMatrix.h"
+#include "iftMemory.h"
+
+/** Alignment (in bytes) of every block returned by the arena. */
+#define IFT_ARENA_ALIGNMENT 32
+
+typedef struct ift_arena_chunk iftArenaChunk;
+
+/**
+ * @brief Bump allocator for per-angle temporaries.
+ */
+typedef struct ift_arena {
+    /** Main buffer. */
+    char *buf;
+    /** Size of the main buffer in bytes. */
+    size_t size;
+    /** Bytes in use in the main buffer. */
+    size_t used;
+    /** Overflow chunks allocated during the current cycle. */
+    iftArenaChunk *overflow;
+    /** Bytes in use in the overflow chunks. */
+    size_t overflow_used;
+    /** Largest number of bytes used in a single cycle. */
+    size_t peak;
+    /** Number of heap allocations performed by the arena since its creation. */
+    size_t nheap_allocs;
+} iftArena;
+
+
+/**
+ * @brief Creates an arena with an initial buffer of <b>size</b> bytes (it may be 0).
+ */
+iftArena *iftCreateArena(size_t size);
+
+/**
+ * @brief Destroys an arena and every block handed out by it.
+ */
+void iftDestroyArena(iftArena **arena);
+
+/**
+ * @brief Returns a zeroed block of <b>n</b> elements of <b>sz</b> bytes, aligned to IFT_ARENA_ALIGNMENT.
+ * The block is valid until the next iftResetArena() or iftDestroyArena().
+ */
+void *iftArenaAlloc(iftArena *arena, size_t n, size_t sz);
+
+/**
+ * @brief Releases all blocks of the arena at once. Overflow chunks are merged into the main buffer.
+ */
+void iftResetArena(iftArena *arena);
+
+/**
+ * @brief Creates a (zeroed) matrix whose memory belongs to the arena. It must NOT be destroyed with iftDestroyMatrix().
+ */
+iftMatrix *iftArenaCreateMatrix(iftArena *arena, int ncols, int nrows);
+
+/**
+ * @brief Arena versions of iftTranslationMatrix() and iftRotationMatrix() (theta in degrees).
+ * @{
+ */
+iftMatrix *iftArenaTranslationMatrix(iftArena *arena, iftVector T);
+iftMatrix *iftArenaRotationMatrix(iftArena *arena, char axis, float theta);
+/** @} */
+
+/**
+ * @brief Multiplies A by B into an arena matrix. See also iftMultMatricesInBuffer().
+ */
+iftMatrix *iftArenaMultMatrices(iftArena *arena, const iftMatrix *A, const iftMatrix *B);
+
+/**
+ * @brief Multiplies A by B into the already allocated matrix C (C->ncols == B->ncols, C->nrows == A->nrows).
+ * It is meant for the small (4x4, 4x1) matrices of the projectors, so it never allocates memory.
+ */
+void iftMultMatricesInBuffer(const iftMatrix *A, const iftMatrix *B, iftMatrix *C);
+
+/**
+ * @brief Creates a (zeroed) image whose memory belongs to the arena. It must NOT be destroyed with iftDestroyImage().
+ */
+iftImage *iftArenaCreateImage(iftArena *arena, int xsize, int ysize, int zsize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_ARENA_H
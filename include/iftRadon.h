@@ -0,0 +1,214 @@
+/**
+ * @file
+ * @brief Fast (DDA-based) 2D Radon transform.
+ *
+ * The sinogram R of an image has 180 columns (theta = 0..179 degrees) and D rows (rho),
+ * where D is the image diagonal. R(theta, rho) is the sum of the pixels along the ray at
+ * distance rho - D/2 from the image center, orthogonal to the direction theta.
+ *
+ * The ray sums are computed by kernels specialized for the pixel type of the input, all
+ * generated from the same kernel source (src/iftRadonKernel.inc):
+ * - 8-bit and 16-bit images use int32 accumulators, and any other image int64 accumulators;
+ * - all of them step along the rays in Q16.16 fixed point, so the samples of a ray do not depend on the
+ *   pixel type (nor on the values of the image);
+ * - images with a side above 32767 pixels, whose coordinates do not fit into the fixed-point positions,
+ *   use the reference kernel: int32 pixels, float accumulators and float stepping.
+ *
+ * Compiling with -DIFT_RADON_REFERENCE_KERNEL forces the reference kernel for all images.
+ */
+
+#ifndef IFT_RADON_H
+#define IFT_RADON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftImage.h"
+
+/** Number of projection angles of a sinogram (theta = 0..179 degrees). */
+#define IFT_RADON_NANGLES 180
+
+/**
+ * @brief Density (fraction of non-zero pixels) below which iftRadonSelectMethod() proposes the pixel-driven
+ * projector. Measured on the sample images: the pixel-driven projector is faster up to ~40% of non-zero
+ * pixels; the margin keeps dense images on the ray-driven one.
+ */
+#define IFT_RADON_SPARSE_DENSITY 0.2
+
+/**
+ * @brief Maximum number of sub-rays per detector bin of iftOversampledRadonTransform().
+ */
+#define IFT_RADON_MAX_SUBRAYS 16
+
+/**
+ * @brief Projectors of the Radon transform.
+ */
+typedef enum {
+    /** Traces each ray by the DDA algorithm: iftFastRadonTransform() */
+    IFT_RADON_RAY_DRIVEN,
+    /** Splats each non-zero pixel along its sinusoid: iftSparseRadonTransform() */
+    IFT_RADON_PIXEL_DRIVEN
+} iftRadonMethod;
+
+/**
+ * @brief Pixel types of the Radon projector kernels.
+ */
+typedef enum {
+    IFT_RADON_INT32,
+    IFT_RADON_UINT16,
+    IFT_RADON_UINT8
+} iftRadonPixelType;
+
+
+/**
+ * @brief Number of detector bins (sinogram rows) used for an image: its diagonal, truncated.
+ */
+int iftRadonNumberOfBins(const iftImage *img);
+
+/**
+ * @brief Returns the narrowest pixel type able to hold all values of the image, in one pass over its pixels.
+ * Images with a side above 32767 pixels are always int32: their coordinates do not fit into the Q16.16
+ * positions of the fixed-point kernels.
+ */
+iftRadonPixelType iftRadonNarrowestPixelType(const iftImage *img);
+
+/**
+ * @brief Returns the name of a pixel type ("uint8", "uint16" or "int32").
+ */
+const char *iftRadonPixelTypeName(iftRadonPixelType type);
+
+/**
+ * @brief Endpoints of the ray traced inside the image for the sinogram bin (theta, rho).
+ *
+ * @return 1 if the ray crosses the image, 0 otherwise.
+ */
+int iftRadonRayEndpoints(const iftImage *img, int theta, int rho, iftVoxel *p1, iftVoxel *pn);
+
+/**
+ * @brief Computes the Radon transform of a 2D image by tracing each ray with the DDA algorithm.
+ * The kernel is chosen by iftRadonNarrowestPixelType().
+ *
+ * The rays of every angle are clipped against the image on their own; they are not derived from those of
+ * 0..45 degrees by symmetry. The ray origins are truncated to pixels before the clipping, and the truncation
+ * of a mirrored origin is one pixel off the mirror of the truncated one, so mirrored rays would differ from
+ * the clipped ones (and from the sinograms of the plans, the EM projectors and the splatting offsets of the
+ * reconstructions). The clipping costs about 21% of the transform of 128 x 128 images, 5% at 512 x 512 and
+ * 1% at 2048 x 2048.
+ *
+ * @param img Input 2D image.
+ * @return Sinogram with IFT_RADON_NANGLES columns and iftRadonNumberOfBins() rows.
+ */
+iftImage *iftFastRadonTransform(const iftImage *img);
+
+/**
+ * @brief Computes the Radon transform of a 2D image by rotating the image for each angle and summing
+ * its columns (the original, slow projector; see iftRadonTransform2D).
+ *
+ * @param img Input 2D image.
+ * @return Sinogram with IFT_RADON_NANGLES columns and iftRadonNumberOfBins() rows.
+ */
+iftImage *iftRotationRadonTransform(const iftImage *img);
+
+/**
+ * @brief Computes only some regions (tiles) of the sinogram of a 2D image.
+ *
+ * Each tile is a bounding box in the sinogram domain: x is the angle theta (0..179) and y is the
+ * detector bin rho (0..iftRadonNumberOfBins()-1), both inclusive. Tiles may overlap and are clipped
+ * to the sinogram. Only the rays inside the tiles are traced, so the cost is proportional to the
+ * requested area. The other sinogram values are zero.
+ *
+ * @param img Input 2D image.
+ * @param tiles Regions of the sinogram to be computed.
+ * @param ntiles Number of tiles.
+ * @return Sinogram with IFT_RADON_NANGLES columns and iftRadonNumberOfBins() rows.
+ */
+iftImage *iftFastRadonTransformTiles(const iftImage *img, const iftBoundingBox *tiles, int ntiles);
+
+/**
+ * @brief Same as iftFastRadonTransformTiles(), but it overwrites only the tiles of an existing sinogram R
+ * of the image (e.g. to refresh a region during an interactive inspection).
+ */
+void iftFastRadonTransformTilesInPlace(const iftImage *img, const iftBoundingBox *tiles, int ntiles, iftImage *R);
+
+/**
+ * @brief Updates the sinogram R of the image prev to the sinogram of curr, when they differ only inside
+ * the bounding box dirty.
+ *
+ * Since the Radon transform is linear, only the projection of curr - prev is added to R, and it is
+ * traced only along the rays (and the ray samples) crossing the box. The ray samples depend on the image
+ * size only, so no pixel outside the box is read and the cost is proportional to the size of the changed
+ * region. The result is the same as iftFastRadonTransform(curr), bin by bin.
+ *
+ * The reference kernel (see above) accumulates the float positions of a ray from its start, so each ray
+ * crossing the box is walked from its start up to the box, and the float sums may differ by their rounding.
+ *
+ * @param R Sinogram of prev (in/out).
+ * @param prev Previous image.
+ * @param curr Current image, equal to prev outside the dirty box.
+ * @param dirty Region of the image that changed (clipped to the image domain).
+ */
+void iftUpdateFastRadonTransform(iftImage *R, const iftImage *prev, const iftImage *curr, iftBoundingBox dirty);
+
+/**
+ * @brief Computes the Radon transform of a 2D image by splatting only its non-zero pixels.
+ *
+ * For each angle, the pixel (x, y) is added to the bin rho = D/2 + x' cos(theta) + y' sin(theta), where
+ * (x', y') are its coordinates relative to the image center. Bins are weighted to match the sampling of the
+ * ray-driven projector, so both sinograms agree up to their discretization (a relative L1 difference of
+ * 2-4% on the filled sample images and about 12% on thin contours). The cost is proportional to the number
+ * of non-zero pixels, which suits binary and edge images.
+ *
+ * @param img Input 2D image.
+ * @return Sinogram with IFT_RADON_NANGLES columns and iftRadonNumberOfBins() rows.
+ */
+iftImage *iftSparseRadonTransform(const iftImage *img);
+
+/**
+ * @brief Computes the Radon transform of a 2D image with nsubrays parallel sub-rays per detector bin,
+ * evenly spaced across the bin and averaged (a box filter over the bin width).
+ *
+ * A single ray per bin aliases the fine details of the image into the sinogram. The sub-rays of a bin are the
+ * clipped ray of iftFastRadonTransform() shifted across the bin, and they take its DDA samples (one per pixel
+ * along its major axis, in Q16.16 positions): with nsubrays = 1 the result is iftFastRadonTransform() (with the
+ * reference kernel, up to its float positions), and with more sub-rays it only adds the filtering (0.1-3.2%
+ * relative L1 from it on the sample images). Sub-rays beyond the border of the image read its border pixel, so
+ * a constant image has the same sinogram for any nsubrays.
+ *
+ * The sub-rays of a sample fall into at most 3 pixels (2 for nsubrays <= 3), which are weighted by the number
+ * of sub-rays inside them, so the cost grows with the pixels read rather than with nsubrays. Measured on the
+ * sample images on one core, it costs 1.0-1.1 times iftFastRadonTransform() for nsubrays = 1, 1.6-2.6 times for
+ * 2-4 sub-rays (about as much as 2 rays per bin) and 2.1-3.6 times for 8-16 sub-rays.
+ *
+ * @param img Input 2D image.
+ * @param nsubrays Number of sub-rays per bin, in [1, IFT_RADON_MAX_SUBRAYS].
+ * @return Sinogram with IFT_RADON_NANGLES columns and iftRadonNumberOfBins() rows.
+ */
+iftImage *iftOversampledRadonTransform(const iftImage *img, int nsubrays);
+
+/**
+ * @brief Fraction of non-zero pixels of an image.
+ */
+float iftRadonDensity(const iftImage *img);
+
+/**
+ * @brief Fastest projector for an image, by its density (see IFT_RADON_SPARSE_DENSITY).
+ *
+ * The pixel-driven projector is a different discretization from the ray-driven one (see
+ * iftSparseRadonTransform()), so it is never used implicitly: callers that accept its sinograms opt in by
+ * passing this method to iftRadonTransform(). Anything that relies on the ray geometry (line extraction,
+ * incremental updates, plans, reconstructions) needs iftFastRadonTransform().
+ */
+iftRadonMethod iftRadonSelectMethod(const iftImage *img);
+
+/**
+ * @brief Computes the Radon transform of a 2D image with the given projector: iftFastRadonTransform() or
+ * iftSparseRadonTransform().
+ */
+iftImage *iftRadonTransform(const iftImage *img, iftRadonMethod method);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_H
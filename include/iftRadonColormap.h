@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @brief Color mapping of sinograms for visualization.
+ *
+ * The colors of a 256-entry table are looked up once, in RGB, and written directly into an interleaved
+ * RGB buffer, which is then saved as an RGB PNG. No pixel goes through the YCbCr color space of the color
+ * iftImage.
+ */
+
+#ifndef IFT_RADON_COLORMAP_H
+#define IFT_RADON_COLORMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftImage.h"
+#include "iftColor.h"
+
+/**
+ * @brief Lookup table of 256 RGB colors.
+ */
+typedef struct ift_radon_colormap {
+    uchar rgb[256][3];
+} iftRadonColormap;
+
+
+/**
+ * @brief Hot-iron colormap (iftCreateHotIronColorTable()) as a lookup table.
+ */
+iftRadonColormap iftRadonHotIronColormap(void);
+
+/**
+ * @brief Maps an image with values in [0, 255] (e.g. a sinogram normalized by iftNormalize()) to colors.
+ * Values out of the range are clamped.
+ *
+ * @param img Input image.
+ * @param cmap Colormap.
+ * @return Interleaved RGB buffer (3 * img->n bytes).
+ */
+uchar *iftRadonApplyColormap(const iftImage *img, const iftRadonColormap *cmap);
+
+/**
+ * @brief Writes an interleaved RGB buffer as an 8-bit RGB PNG.
+ */
+void iftRadonWriteRGBPNG(const uchar *rgb, int xsize, int ysize, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_COLORMAP_H
@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Rotation-invariant shape descriptor from the Radon transform (R-signature).
+ *
+ * The R-signature of an image is the energy of each sinogram column, r(theta) = sum_rho R(theta, rho)^2.
+ * It does not depend on translations, and a rotation of the image shifts it circularly (it has period 180).
+ * The descriptor is the magnitude of its DFT coefficients k = 1..nfeats, divided by the magnitude of the
+ * coefficient 0, which makes it invariant to rotation, translation and contrast.
+ */
+
+#ifndef IFT_RADON_DESCRIPTOR_H
+#define IFT_RADON_DESCRIPTOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftRadon.h"
+#include "iftDataSet.h"
+
+/** Maximum number of features of the descriptor: the distinct DFT magnitudes of a real signal of length IFT_RADON_NANGLES. */
+#define IFT_RADON_SIGNATURE_MAX_FEATS (IFT_RADON_NANGLES / 2)
+
+
+/**
+ * @brief Computes the R-signature of a sinogram computed by iftFastRadonTransform().
+ * The energies are corrected for the sampling of the DDA, which takes max(|cos|, |sin|) samples per unit length.
+ *
+ * @param R Sinogram.
+ * @return Array with the energy of each of the IFT_RADON_NANGLES columns.
+ */
+double *iftRadonSignature(const iftImage *R);
+
+/**
+ * @brief Computes the R-signature descriptor of an image.
+ *
+ * @param img Input 2D image.
+ * @param nfeats Number of features, at most IFT_RADON_SIGNATURE_MAX_FEATS.
+ * @return Array with the nfeats features.
+ */
+float *iftRadonSignatureDescriptor(const iftImage *img, int nfeats);
+
+/**
+ * @brief Builds a dataset with the R-signature descriptors of a batch of images, in parallel.
+ * Sample s describes imgs[s] and has id s.
+ *
+ * The images of the same size share one iftRadonPlan, executed on batches of images
+ * (iftExecuteRadonPlanBatch()); an image of a size of its own gets its own iftFastRadonTransform().
+ *
+ * @param imgs Input 2D images.
+ * @param nimgs Number of images.
+ * @param nfeats Number of features, at most IFT_RADON_SIGNATURE_MAX_FEATS.
+ * @return The dataset.
+ */
+iftDataSet *iftRadonSignatureDataSet(iftImage **imgs, int nimgs, int nfeats);
+
+/**
+ * @brief Builds a dataset with the R-signature descriptors of the shapes of the regions of a label image,
+ * in parallel. Sample l - 1 describes the binary mask of the region with label l = 1..max label (cropped to its
+ * bounding box) and has id l. Empty labels get null descriptors.
+ *
+ * @param label Label image (0 is the background).
+ * @param nfeats Number of features, at most IFT_RADON_SIGNATURE_MAX_FEATS.
+ * @return The dataset.
+ */
+iftDataSet *iftRadonSignatureDataSetFromLabels(const iftImage *label, int nfeats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_DESCRIPTOR_H
@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief Statistical reconstruction of 2D images from sinograms of Poisson counts: ML-EM and ordered-subsets
+ * EM (OS-EM).
+ *
+ * The system matrix is the one of iftFastRadonTransform(): the bin (theta, rho) sums the pixels visited by the
+ * DDA of its clipped ray, with the same fixed-point stepping. The forward projector
+ * follows the same rays and the back-projector adds the bins back to the same pixels, so the pair is matched
+ * (the back-projector is the exact transpose of the forward projector) and the reconstructions have the scale
+ * of the image.
+ *
+ * Each update of OS-EM uses one subset of the angles (theta % nsubsets == s) and multiplies the image by
+ * the back-projection of the ratios between the measured and the projected bins of the subset, divided by
+ * the sensitivity image of the subset (the back-projection of ones). ML-EM is OS-EM with a single subset.
+ * Everything that depends only on the image size and the subsets (the clipped rays and the sensitivity
+ * images) is computed once by iftCreateRadonEM(), and the buffers of the updates are kept by the geometry, so
+ * the iterations do not allocate memory.
+ */
+
+#ifndef IFT_RADON_EM_H
+#define IFT_RADON_EM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftRadon.h"
+#include "iftFImage.h"
+
+/** Default number of subsets of OS-EM: 10 subsets of 18 angles. */
+#define IFT_RADON_EM_SUBSETS 10
+/** Default number of iterations (passes over all the subsets) of OS-EM. */
+#define IFT_RADON_EM_ITERATIONS 4
+
+/** Opaque geometry of the EM reconstructions of one image size. */
+typedef struct ift_radon_em iftRadonEM;
+
+
+/**
+ * @brief Creates the geometry of the EM reconstructions of xsize x ysize images: the rays of all the bins and
+ * the sensitivity image of each subset (nsubsets * xsize * ysize floats). The updates use all the OpenMP
+ * threads: each back-projects into its own band of rows of a single buffer, so the memory of the updates does
+ * not grow with the number of threads.
+ *
+ * @param xsize Width of the images, at most 32767 (the rays are traced in Q16.16 fixed point).
+ * @param ysize Height of the images, at most 32767.
+ * @param nsubsets Number of subsets of the angles, in [1, IFT_RADON_NANGLES] (1 for ML-EM).
+ * @return The geometry.
+ */
+iftRadonEM *iftCreateRadonEM(int xsize, int ysize, int nsubsets);
+
+/**
+ * @brief Destroys the geometry of the EM reconstructions.
+ */
+void iftDestroyRadonEM(iftRadonEM **em);
+
+/**
+ * @brief Number of subsets of the angles of the geometry.
+ */
+int iftRadonEMNumberOfSubsets(const iftRadonEM *em);
+
+/**
+ * @brief Runs niters iterations of OS-EM (one update per subset each) on the image x, in place.
+ *
+ * The pixels seen by no ray of a subset are not changed by its update. Bins whose projection is zero are
+ * ignored.
+ *
+ * @param em Geometry of the image size.
+ * @param R Sinogram of counts (IFT_RADON_NANGLES columns, no negative values).
+ * @param x Current image, non-negative (in/out).
+ * @param niters Number of iterations.
+ */
+void iftRadonEMIterate(iftRadonEM *em, const iftImage *R, iftFImage *x, int niters);
+
+/**
+ * @brief Reconstructs an image from a sinogram of counts by niters iterations of OS-EM (see
+ * iftRadonEMIterate()), from a uniform image with the total counts of the sinogram.
+ *
+ * @param em Geometry of the image size.
+ * @param R Sinogram of counts (IFT_RADON_NANGLES columns, no negative values).
+ * @param niters Number of iterations, e.g. IFT_RADON_EM_ITERATIONS.
+ * @return The reconstructed image.
+ */
+iftFImage *iftRadonEMReconstruction(iftRadonEM *em, const iftImage *R, int niters);
+
+/**
+ * @brief Projects an image along the rays of all the bins: the forward projector of the updates. The
+ * projections of the integer images of 8 and 16 bits are those of iftFastRadonTransform(), except in builds
+ * with -DIFT_RADON_REFERENCE_KERNEL, whose fast transform steps in float.
+ *
+ * @param em Geometry of the image size.
+ * @param x Image.
+ * @return Sinogram with IFT_RADON_NANGLES columns.
+ */
+iftFImage *iftRadonEMForwardProjection(const iftRadonEM *em, const iftFImage *x);
+
+/**
+ * @brief Back-projects a sinogram along the rays of all the bins: the transpose of
+ * iftRadonEMForwardProjection(), i.e. the back-projector of the updates.
+ *
+ * @param em Geometry of the image size.
+ * @param y Sinogram with IFT_RADON_NANGLES columns.
+ * @return Image of the size of the geometry.
+ */
+iftFImage *iftRadonEMBackProjection(const iftRadonEM *em, const iftFImage *y);
+
+/**
+ * @brief Mean time (ms) of the subset updates run by the geometry so far.
+ */
+double iftRadonEMMeanUpdateTime(const iftRadonEM *em);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_EM_H
@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Self-contained FFT of the Radon module: mixed-radix complex and real transforms of any length,
+ * batched over many sequences, and the ramp filtering of sinograms.
+ *
+ * A plan holds the factorization of the length (radices 4, 2, 3, 5 and then any prime) and the twiddle
+ * factors of all its stages, computed once and shared by every execution. The stages are Stockham
+ * autosort passes, so the output is in natural order without a bit-reversal pass.
+ *
+ * Batches are interleaved: element k of sequence b is x[k * howmany + b]. This is the layout of the
+ * sinogram columns, where howmany = IFT_RADON_NANGLES and x is the sinogram buffer itself. The butterflies
+ * of every stage then run over contiguous elements of all the sequences, which the compiler vectorizes.
+ * For the same reason, the real and imaginary parts are separate arrays.
+ *
+ * The transforms are unnormalized: the inverse transform of the forward transform is n times the input.
+ */
+
+#ifndef IFT_RADON_FFT_H
+#define IFT_RADON_FFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftRadon.h"
+#include "iftFImage.h"
+
+/** Sign of the exponent of the forward transform: X[k] = sum_j x[j] exp(-2 pi i j k / n). */
+#define IFT_RADON_FFT_FORWARD -1
+/** Sign of the exponent of the inverse (unnormalized) transform. */
+#define IFT_RADON_FFT_INVERSE  1
+
+/** Opaque FFT plan of one length. */
+typedef struct ift_radon_fft iftRadonFFT;
+
+
+/**
+ * @brief Creates the FFT plan of sequences of length n (any n >= 1, fastest for products of 2, 3 and 5).
+ */
+iftRadonFFT *iftCreateRadonFFT(int n);
+
+/**
+ * @brief Destroys an FFT plan.
+ */
+void iftDestroyRadonFFT(iftRadonFFT **fft);
+
+/**
+ * @brief Length of the sequences of the plan.
+ */
+int iftRadonFFTLength(const iftRadonFFT *fft);
+
+/**
+ * @brief Smallest length >= n whose only prime factors are 2, 3 and 5, e.g., for zero padding.
+ */
+int iftRadonFFTGoodSize(int n);
+
+/**
+ * @brief In-place complex DFT of howmany interleaved sequences.
+ *
+ * @param fft Plan of the length n.
+ * @param re Real parts (n * howmany values, element k of sequence b at k * howmany + b).
+ * @param im Imaginary parts, in the same layout.
+ * @param howmany Number of sequences.
+ * @param sign IFT_RADON_FFT_FORWARD or IFT_RADON_FFT_INVERSE.
+ */
+void iftExecuteRadonFFT(const iftRadonFFT *fft, double *re, double *im, int howmany, int sign);
+
+/**
+ * @brief Forward DFT of howmany interleaved real sequences: only the n/2 + 1 first coefficients, since the
+ * others are their conjugates. Even lengths are computed by a complex FFT of half the length.
+ *
+ * @param fft Plan of the length n.
+ * @param in Real sequences (n * howmany values, interleaved).
+ * @param re Real parts of the coefficients ((n/2 + 1) * howmany values, interleaved).
+ * @param im Imaginary parts of the coefficients, in the same layout.
+ * @param howmany Number of sequences.
+ */
+void iftExecuteRadonRealFFT(const iftRadonFFT *fft, const double *in, double *re, double *im, int howmany);
+
+/**
+ * @brief Inverse (unnormalized) DFT of the n/2 + 1 first coefficients of howmany real sequences, as given by
+ * iftExecuteRadonRealFFT(): out is n times the sequences they came from.
+ */
+void iftExecuteRadonInverseRealFFT(const iftRadonFFT *fft, const double *re, const double *im, double *out,
+                                   int howmany);
+
+/**
+ * @brief Frequency response of the band-limited ramp filter (see iftRadonRampFilter()) for the length n of a
+ * plan: H[k], k = 0..n/2, which is about k / n (and slightly positive at k = 0, since the filter is truncated
+ * to n samples).
+ */
+void iftRadonRampResponse(const iftRadonFFT *fft, double *H);
+
+/**
+ * @brief Ramp (Ram-Lak) filtering of the projections of a sinogram, as required by the filtered
+ * back-projection.
+ *
+ * Each column (angle) is convolved with the band-limited ramp filter h[0] = 1/4, h[k] = -1/(pi k)^2 for
+ * odd k and 0 for even k. The convolution is computed by batched real FFTs of all the columns, zero-padded
+ * to iftRadonFFTGoodSize(2 * nbins) so that it does not wrap around.
+ *
+ * @param R Sinogram computed by iftFastRadonTransform() (IFT_RADON_NANGLES columns).
+ * @return The filtered sinogram, of the same size.
+ */
+iftFImage *iftRadonRampFilter(const iftImage *R);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_FFT_H
@@ -0,0 +1,174 @@
+/**
+ * @file
+ * @brief Stable C API of the Radon projectors (libradon).
+ *
+ * A plan holds everything that depends only on the image size: the clipped rays of all
+ * (theta, rho) bins and the row offsets of the input. It is created once per geometry and executed
+ * on any number of images of that size, given as plain in-memory buffers (no iftImage, no file I/O).
+ * The plan is opaque, so its layout may change without breaking the callers.
+ *
+ * Buffers are row-major: the input has xsize * ysize pixels and the output (the sinogram) has
+ * IFT_RADON_NANGLES columns (theta) and iftRadonPlanNumberOfBins() rows (rho). The results are the
+ * same as iftFastRadonTransform().
+ *
+ * The library is built with "make libradon" (lib/libradon.so).
+ */
+
+#ifndef IFT_RADON_PLAN_H
+#define IFT_RADON_PLAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftRadon.h"
+
+/** Version of the API: incremented on every incompatible change. */
+#define IFT_RADON_API_VERSION 1
+
+/** Opaque Radon transform plan. */
+typedef struct ift_radon_plan iftRadonPlan;
+
+/**
+ * @brief How an execution splits the sinogram among its threads.
+ */
+typedef enum {
+    /**
+     * Tiles of consecutive bins of one angle, sized by the lengths of their clipped rays. Each thread starts
+     * with a contiguous range of tiles of the same estimated cost and, once done, steals tiles from the others.
+     */
+    IFT_RADON_SCHEDULE_STEALING = 0,
+    /** Whole angles, split into equal contiguous ranges (OpenMP static schedule). */
+    IFT_RADON_SCHEDULE_STATIC = 1
+} iftRadonSchedule;
+
+
+/**
+ * @brief Version of the API the library was built with (IFT_RADON_API_VERSION).
+ */
+int iftRadonAPIVersion(void);
+
+/**
+ * @brief Creates the plan of the Radon transform of xsize x ysize images. It uses all the OpenMP threads
+ * by default (see iftSetRadonPlanNumberOfThreads()).
+ */
+iftRadonPlan *iftCreateRadonPlan(int xsize, int ysize);
+
+/**
+ * @brief Same as iftCreateRadonPlan(), through a cache of plans ("wisdom") in the directory dir.
+ *
+ * The rays and the work tiles of a plan are saved to a file of the directory (created with its parents if needed), keyed by
+ * the image size, the angles, the detector bins and the CPU features the library was built with. Later
+ * calls, from any process, map that file read-only instead of computing the plan, so they cost a few
+ * system calls and one pass over the rays: the sections of the file must lie inside it, and its tiles and
+ * rays inside the sinogram and the image. Files of other versions or builds, and truncated or corrupted
+ * files, are ignored and replaced. A cache directory that cannot be created or written only costs the
+ * computation: the plan is returned, never an error.
+ */
+iftRadonPlan *iftCreateCachedRadonPlan(const char *dir, int xsize, int ysize);
+
+/**
+ * @brief Destroys a plan.
+ */
+void iftDestroyRadonPlan(iftRadonPlan **plan);
+
+/**
+ * @brief Number of detector bins (sinogram rows) of the plan.
+ */
+int iftRadonPlanNumberOfBins(const iftRadonPlan *plan);
+
+/**
+ * @brief Number of values of the output buffer: IFT_RADON_NANGLES * iftRadonPlanNumberOfBins().
+ */
+size_t iftRadonPlanOutputSize(const iftRadonPlan *plan);
+
+/**
+ * @brief Sets the number of threads used by each execution of the plan (1 runs it in the calling thread).
+ */
+void iftSetRadonPlanNumberOfThreads(iftRadonPlan *plan, int nthreads);
+
+/**
+ * @brief Number of threads used by each execution of the plan.
+ */
+int iftRadonPlanNumberOfThreads(const iftRadonPlan *plan);
+
+/**
+ * @brief Sets how each execution of the plan splits the work among its threads (IFT_RADON_SCHEDULE_STEALING by
+ * default). The results do not depend on the schedule.
+ */
+void iftSetRadonPlanSchedule(iftRadonPlan *plan, iftRadonSchedule schedule);
+
+/**
+ * @brief Schedule of the executions of the plan.
+ */
+iftRadonSchedule iftRadonPlanSchedule(const iftRadonPlan *plan);
+
+/**
+ * @brief Enables the NUMA-aware execution of the plan (disabled by default), for hosts with several memory
+ * nodes.
+ *
+ * The threads of each execution are split into groups of consecutive threads, one per node, and pinned to
+ * the CPUs of their node. The first thread of each node copies the input into node-local memory, and the
+ * threads of a node trace it from that copy. With the work-stealing schedule, each node also owns a band of
+ * sinogram rows of the same cost, so an output buffer whose pages were not touched before the execution
+ * (e.g., fresh from malloc()) gets each band first touched by its own node. Threads steal from their own
+ * node first. The memory traffic across nodes is reported by the remote_samples and remote_bins counters of
+ * the statistics (see iftRadonStats.h). On a single-node host this only pins the threads.
+ */
+void iftSetRadonPlanNuma(iftRadonPlan *plan, bool numa);
+
+/**
+ * @brief Whether the executions of the plan are NUMA-aware.
+ */
+bool iftRadonPlanNuma(const iftRadonPlan *plan);
+
+/**
+ * @brief Computes the sinogram of an int32 image. Images whose values fit into 8 or 16 bits use the
+ * narrow kernels, as iftFastRadonTransform() does.
+ *
+ * Each execution traces a copy of the image followed by its transpose: the rays of the angles below 45 and
+ * above 135 degrees, which run down the image columns, are stored transposed in the plan and traced along the
+ * rows of the transposed copy. On one thread, this makes the executions of 1024 x 1024 images 10-25% faster;
+ * below 512 x 512, where the image stays in the caches, the difference is within the noise.
+ *
+ * A plan is never modified by its executions, so several threads may execute the same plan at once.
+ *
+ * @param plan Plan of the image size.
+ * @param in Image pixels (xsize * ysize).
+ * @param out Sinogram (iftRadonPlanOutputSize() values), overwritten.
+ */
+void iftExecuteRadonPlan(const iftRadonPlan *plan, const int *in, int *out);
+
+/**
+ * @brief Same as iftExecuteRadonPlan() for an 8-bit image.
+ */
+void iftExecuteRadonPlanU8(const iftRadonPlan *plan, const uchar *in, int *out);
+
+/**
+ * @brief Same as iftExecuteRadonPlan() for a 16-bit image.
+ */
+void iftExecuteRadonPlanU16(const iftRadonPlan *plan, const ushort *in, int *out);
+
+/**
+ * @brief Computes the sinograms of nimgs int32 images of the plan size in shared ray traversals.
+ *
+ * The images are interleaved pixel by pixel and traced together: the address of each ray sample is
+ * computed once and the contiguous values of all the images are added to their own ray sums. All the
+ * kernels step through the same fixed-point samples, so images of any pixel type share a traversal and every
+ * sinogram is the same as the one of iftExecuteRadonPlan(); the images of the reference kernel (see
+ * iftRadon.h) are executed one by one. Up to 16 images share a traversal, which
+ * makes batches of 16 or more images 3-7 times faster than one execution per image; groups of fewer than
+ * 4 images are executed one by one.
+ *
+ * @param plan Plan of the image size.
+ * @param in Pixels of each image (xsize * ysize each).
+ * @param nimgs Number of images.
+ * @param out Sinogram of each image (iftRadonPlanOutputSize() values each), overwritten.
+ */
+void iftExecuteRadonPlanBatch(const iftRadonPlan *plan, const int * const *in, int nimgs, int **out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_PLAN_H
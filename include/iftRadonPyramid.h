@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @brief Multi-resolution (pyramid) Radon transform for coarse-to-fine searches.
+ *
+ * Level 0 holds the input image; each next level halves the image size (iftResizeImage()) and doubles
+ * the angle step of its sinogram. All sinograms keep the layout of iftFastRadonTransform()
+ * (IFT_RADON_NANGLES columns, one per degree), so a window (theta, rho) of one level maps to another
+ * level just by rescaling rho (see iftMapRadonPyramidWindow()).
+ *
+ * Only the coarsest sinogram is computed on creation. The finer levels are computed on demand by
+ * iftRefineRadonPyramid(), only inside the windows around the candidates of the coarser levels.
+ */
+
+#ifndef IFT_RADON_PYRAMID_H
+#define IFT_RADON_PYRAMID_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftRadon.h"
+
+/** Smallest image size (in each axis) of a pyramid level. */
+#define IFT_RADON_PYRAMID_MIN_SIZE 8
+
+/**
+ * @brief Radon pyramid.
+ */
+typedef struct ift_radon_pyramid {
+    /** Number of levels. Level 0 has the resolution of the input image. */
+    int nlevels;
+    /** Image of each level. */
+    iftImage **img;
+    /** Sinogram of each level. Only the computed windows are filled, the rest is zero. */
+    iftImage **R;
+    /** Angle step (in degrees) of each level: 2^level. Only the columns multiple of it are computed. */
+    int *angle_step;
+} iftRadonPyramid;
+
+
+/**
+ * @brief Builds the images of a Radon pyramid and computes the sinogram of its coarsest level.
+ *
+ * @param img Input 2D image (level 0).
+ * @param nlevels Number of levels. The coarsest image must be at least IFT_RADON_PYRAMID_MIN_SIZE pixels
+ * in each axis and its angle step must be smaller than IFT_RADON_NANGLES.
+ * @return The pyramid.
+ */
+iftRadonPyramid *iftCreateRadonPyramid(const iftImage *img, int nlevels);
+
+/**
+ * @brief Destroys a Radon pyramid.
+ */
+void iftDestroyRadonPyramid(iftRadonPyramid **pyr);
+
+/**
+ * @brief Computes the sinogram of a level inside the given windows, at the angle step of the level.
+ *
+ * @param pyr Radon pyramid.
+ * @param level Level to be refined.
+ * @param windows Windows in the sinogram coordinates of the level (x = theta, y = rho).
+ * @param nwindows Number of windows.
+ */
+void iftRefineRadonPyramid(iftRadonPyramid *pyr, int level, const iftBoundingBox *windows, int nwindows);
+
+/**
+ * @brief Maps a sinogram window of one level to the sinogram coordinates of another level.
+ * The angles are kept and rho is rescaled around the sinogram center. The mapped window is
+ * enlarged to whole bins and clipped to the sinogram of the target level.
+ */
+iftBoundingBox iftMapRadonPyramidWindow(const iftRadonPyramid *pyr, iftBoundingBox window, int from_level,
+                                        int to_level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_PYRAMID_H
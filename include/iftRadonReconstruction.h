@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Reconstruction of 2D images from their sinograms (inverse Radon transform).
+ *
+ * The sinograms are those of iftRadon.h: the bin rho of the angle theta holds the ray sum at distance
+ * rho + 1/2 - D/2 from the image center, taking max(|cos theta|, |sin theta|) samples per unit length. The
+ * reconstructions divide each angle by that sampling density, so they have the scale of the image.
+ *
+ * Three inversions are provided:
+ * - the filtered back-projection, which ramp-filters the projections and smears each of them back over the
+ *   image: O(N^3) for an N x N image, since every pixel visits every angle;
+ * - the hierarchical back-projection (Basu and Bresler), which splits the image recursively into quadrants
+ *   and gives each quadrant the projections shifted to its center. A quadrant of half the size needs only
+ *   half the angles, so adjacent angles are merged as the quadrants shrink, and the leaves back-project few
+ *   angles: O(N^2 log N);
+ * - the direct Fourier (gridding) reconstruction, which uses the central slice theorem: the 1D FFT of a
+ *   projection is the 2D FT of the image along a line through the origin. The polar samples of all the
+ *   projections are weighted by their density and interpolated onto a Cartesian frequency grid by a
+ *   Kaiser-Bessel kernel, and a single 2D inverse FFT, divided by the FT of the kernel (deapodization),
+ *   gives the image: O(N^2 log N).
+ */
+
+#ifndef IFT_RADON_RECONSTRUCTION_H
+#define IFT_RADON_RECONSTRUCTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftRadon.h"
+#include "iftFImage.h"
+
+/** Oversampling of the Cartesian frequency grid of the gridding reconstruction (grid size / image size). */
+#define IFT_RADON_GRIDDING_OVERSAMPLING 2
+/** Width (grid cells) of the Kaiser-Bessel kernel of the gridding reconstruction. */
+#define IFT_RADON_GRIDDING_KERNEL_WIDTH 6
+/** Default accuracy of the hierarchical back-projection (see iftRadonHierarchicalBackProjection()). */
+#define IFT_RADON_HIERARCHICAL_ACCURACY 4.0
+
+
+/**
+ * @brief Reconstructs an image from its sinogram by the filtered back-projection (Ram-Lak filter, see
+ * iftRadonRampFilter(), and linear interpolation between bins).
+ *
+ * @param R Sinogram (IFT_RADON_NANGLES columns) of an image of xsize x ysize pixels.
+ * @param xsize Width of the image.
+ * @param ysize Height of the image.
+ * @return The reconstructed image.
+ */
+iftFImage *iftRadonFilteredBackProjection(const iftImage *R, int xsize, int ysize);
+
+/**
+ * @brief Reconstructs an image from its sinogram by the hierarchical back-projection: the same filtering as
+ * iftRadonFilteredBackProjection(), but the back-projection is split recursively.
+ *
+ * Each sub-image gets its own projections, resampled around its center over its diameter only (by cubic
+ * interpolation, at 2 samples per bin). When a quadrant of side m is split from its sub-image, it keeps half
+ * of the angles if they are still at least accuracy * m / 2, and each dropped angle is split between its two
+ * neighbors. The sub-images up to 8 x 8 pixels back-project their remaining angles directly. A merged angle
+ * is off by up to about 2 / accuracy bins at the corners of the quadrant, so accuracy trades the error for
+ * the speed. A large accuracy (>= IFT_RADON_NANGLES) merges no angles, and the result is the back-projection
+ * of the interpolated projections.
+ *
+ * @param R Sinogram (IFT_RADON_NANGLES columns) of an image of xsize x ysize pixels.
+ * @param xsize Width of the image.
+ * @param ysize Height of the image.
+ * @param accuracy Minimum number of angles kept by the sub-images per pixel of side, times 2 (> 0), e.g.
+ * IFT_RADON_HIERARCHICAL_ACCURACY.
+ * @return The reconstructed image.
+ */
+iftFImage *iftRadonHierarchicalBackProjection(const iftImage *R, int xsize, int ysize, double accuracy);
+
+/**
+ * @brief Reconstructs an image from its sinogram by direct Fourier inversion with gridding.
+ *
+ * The projections are transformed by batched real FFTs (zero-padded to twice the number of bins), weighted
+ * by the area of their polar cells (|rho| d_rho d_theta, taken from the response of the ramp filter, see
+ * iftRadonRampResponse()) and spread onto a frequency grid
+ * IFT_RADON_GRIDDING_OVERSAMPLING times the image size by a Kaiser-Bessel kernel of
+ * IFT_RADON_GRIDDING_KERNEL_WIDTH cells. The oversampling keeps the aliases of the kernel out of the image.
+ *
+ * @param R Sinogram (IFT_RADON_NANGLES columns) of an image of xsize x ysize pixels.
+ * @param xsize Width of the image.
+ * @param ysize Height of the image.
+ * @return The reconstructed image.
+ */
+iftFImage *iftRadonGriddingReconstruction(const iftImage *R, int xsize, int ysize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_RECONSTRUCTION_H
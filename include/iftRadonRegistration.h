@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @brief Rigid 2D registration (rotation and translation) in the Radon space.
+ *
+ * A rotation of the image by phi shifts its sinogram circularly by phi along theta (the column
+ * theta + 180 is the column theta with rho mirrored), and a translation t shifts each column theta by
+ * t . (cos(theta), sin(theta)) along rho. Both parameters are then estimated from 1D signals:
+ * - the rotation, by the FFT cross-correlation of the angular profiles sum_rho R(theta, rho)^2 (the
+ *   R-signatures of iftRadonDescriptor.h), which do not depend on the translation;
+ * - the translation, by the least-squares fit of the shifts between the centroids of the matched columns.
+ * The angular profiles have period 180, so the skewness of the matched columns, whose sign flips when a
+ * column is mirrored, tells phi from phi + 180.
+ *
+ * The objects must remain inside both images, since the projections of clipped parts are lost.
+ */
+
+#ifndef IFT_RADON_REGISTRATION_H
+#define IFT_RADON_REGISTRATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftRadon.h"
+
+/**
+ * @brief Rigid transformation from the fixed to the moving image: a pixel p of the fixed image is
+ * mapped to Rot(theta) (p - c) + c + t, where c is the image center.
+ */
+typedef struct ift_radon_rigid_transform {
+    /** Rotation angle (degrees) in (-180, 180], from the +x axis to the +y axis of the image. */
+    float theta;
+    /** Translation (pixels). */
+    iftVector t;
+    /** Root mean square residual (pixels) of the translation fit over the angles. */
+    float residual;
+} iftRadonRigidTransform;
+
+
+/**
+ * @brief Estimates the rigid transformation between two sinograms of images with the same domain.
+ *
+ * @param R_fixed Sinogram of the fixed image, computed by iftFastRadonTransform().
+ * @param R_moving Sinogram of the moving image, computed by iftFastRadonTransform().
+ * @param img Image of the sinograms (only its domain is used, to locate the traced rays).
+ * @return The transformation from the fixed to the moving image.
+ */
+iftRadonRigidTransform iftRadonRegisterSinograms(const iftImage *R_fixed, const iftImage *R_moving, const iftImage *img);
+
+/**
+ * @brief Estimates the rigid transformation between two images: iftFastRadonTransform() of both followed
+ * by iftRadonRegisterSinograms().
+ */
+iftRadonRigidTransform iftRadonRegisterImages(const iftImage *fixed, const iftImage *moving);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_REGISTRATION_H
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @brief Protocol of the Radon transform server (iftRadonServer).
+ *
+ * The server listens on a UNIX domain socket and exchanges fixed-size messages in the host byte order.
+ * Images and sinograms never go through the socket: they are passed in POSIX shared memory objects
+ * created by the client (shm_open()), so no image codec is involved.
+ *
+ * To transform an image, the client:
+ * 1. writes the image as xsize * ysize int32 pixels (row-major) into a shared memory object;
+ * 2. creates a second object with room for the sinogram: IFT_RADON_NANGLES * nbins int32 values, where
+ *    nbins = (int) sqrt(xsize^2 + ysize^2) (see iftRadonNumberOfBins());
+ * 3. sends an iftRadonRequest with op IFT_RADON_OP_TRANSFORM and the names of both objects;
+ * 4. receives an iftRadonReply; on success the sinogram is in the output object, row-major with
+ *    IFT_RADON_NANGLES columns (theta) and nbins rows (rho).
+ * The client owns both objects and unlinks them when done. Several requests may be in flight on
+ * different connections: the server batches the requests that arrive together and runs them in parallel.
+ * The sockets are non-blocking on the server side, so a client that sends its request slowly does not
+ * delay the others, and a client that stops reading its replies is disconnected.
+ *
+ * The server keeps the plan of each image size (see iftRadonPlan.h) and executes it directly on the shared
+ * memory objects.
+ *
+ * An IFT_RADON_OP_STATS request is answered by an iftRadonReply followed by an iftRadonServerStats.
+ */
+
+#ifndef IFT_RADON_SERVER_H
+#define IFT_RADON_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "iftRadon.h"
+
+/** First field of every message ("RDN1"). */
+#define IFT_RADON_SERVER_MAGIC 0x52444E31
+/** Maximum length of a shared memory object name, including the terminating '\0'. */
+#define IFT_RADON_SHM_NAME_LEN 64
+/** Maximum width and height of an image. */
+#define IFT_RADON_SERVER_MAX_SIDE 16384
+/** Maximum number of pixels of an image (4096 x 4096). */
+#define IFT_RADON_SERVER_MAX_PIXELS (1L << 24)
+
+/**
+ * @brief Requests of the server.
+ */
+typedef enum {
+    /** Radon transform of the image in the input object into the output object. */
+    IFT_RADON_OP_TRANSFORM = 1,
+    /** Latency statistics of the server. */
+    IFT_RADON_OP_STATS = 2
+} iftRadonServerOp;
+
+/**
+ * @brief Status of a reply.
+ */
+typedef enum {
+    IFT_RADON_STATUS_OK = 0,
+    /** Bad magic or operation, or an image size out of bounds (see IFT_RADON_SERVER_MAX_PIXELS). */
+    IFT_RADON_STATUS_BAD_REQUEST = -1,
+    /** A shared memory object could not be opened or mapped. */
+    IFT_RADON_STATUS_SHM_ERROR = -2,
+    /** A shared memory object is smaller than required. */
+    IFT_RADON_STATUS_SHM_TOO_SMALL = -3
+} iftRadonServerStatus;
+
+/**
+ * @brief Request message.
+ */
+typedef struct ift_radon_request {
+    uint32_t magic;
+    /** An iftRadonServerOp. */
+    uint32_t op;
+    /** Image size. */
+    int32_t xsize, ysize;
+    /** Shared memory objects of the image and the sinogram (e.g. "/radon-in-42"). */
+    char in_shm[IFT_RADON_SHM_NAME_LEN];
+    char out_shm[IFT_RADON_SHM_NAME_LEN];
+} iftRadonRequest;
+
+/**
+ * @brief Reply message.
+ */
+typedef struct ift_radon_reply {
+    uint32_t magic;
+    /** An iftRadonServerStatus. */
+    int32_t status;
+    /** Sinogram size. */
+    int32_t nangles, nbins;
+    /** Time (ms) spent by the server on the request, from its arrival to the reply. */
+    double elapsed_ms;
+} iftRadonReply;
+
+/**
+ * @brief Latency statistics of the transform requests since the server started.
+ */
+typedef struct ift_radon_server_stats {
+    uint64_t nrequests;
+    uint64_t nerrors;
+    uint64_t nbatches;
+    /** Latency (ms) of the successful requests. */
+    double mean_ms, min_ms, max_ms, last_ms;
+    /** Mean number of requests per batch. */
+    double mean_batch_size;
+    /** Number of geometries (image sizes) with a cached plan. */
+    int32_t nplans;
+} iftRadonServerStats;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_SERVER_H
@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief Per-stage timers and counters of the Radon transform programs and projectors.
+ *
+ * The statistics are global and disabled by default (verbosity 0): every timer and counter then costs a
+ * single test. Times are wall-clock seconds summed over all threads, so a parallel stage may report more
+ * time than the run took.
+ */
+
+#ifndef IFT_RADON_STATS_H
+#define IFT_RADON_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftCommon.h"
+#include "iftJson.h"
+
+/**
+ * @brief Timed stages.
+ */
+typedef enum {
+    /** Reading (and decoding) the input image. */
+    IFT_RADON_STAGE_DECODE,
+    /** Ray geometry: matrices and clipping of the rays. */
+    IFT_RADON_STAGE_GEOMETRY,
+    /** Ray sums (or pixel splats) of the projectors. */
+    IFT_RADON_STAGE_TRAVERSAL,
+    /** Normalization of the sinogram for visualization. */
+    IFT_RADON_STAGE_NORMALIZATION,
+    /** Color mapping of the sinogram. */
+    IFT_RADON_STAGE_COLORMAP,
+    /** Writing (and encoding) the output images. */
+    IFT_RADON_STAGE_ENCODE,
+    /** Filtering (or Fourier transform) of the projections by the reconstructions. */
+    IFT_RADON_STAGE_FILTERING,
+    /** Back-projection of the filtered projections. */
+    IFT_RADON_STAGE_BACKPROJECTION,
+    /** Interpolation of the polar Fourier samples onto the Cartesian grid. */
+    IFT_RADON_STAGE_GRIDDING,
+    /** 2D inverse FFT and deapodization of the grid. */
+    IFT_RADON_STAGE_INVERSE_FFT,
+    /** Subset updates of the EM reconstructions (one call per subset). */
+    IFT_RADON_STAGE_EM_UPDATE,
+    IFT_RADON_NSTAGES
+} iftRadonStage;
+
+/**
+ * @brief Counters.
+ */
+typedef enum {
+    /** Rays traced (valid rays only). */
+    IFT_RADON_COUNTER_RAYS,
+    /** Pixels read by the ray sums (or splatted). */
+    IFT_RADON_COUNTER_SAMPLES,
+    /** Heap allocations of the projectors (scratch arenas and pixel buffers). */
+    IFT_RADON_COUNTER_ALLOCS,
+    /** Pixels read by the plan executions from another NUMA node than the reading thread's. */
+    IFT_RADON_COUNTER_REMOTE_SAMPLES,
+    /** Sinogram bins written by the plan executions to another NUMA node than the writing thread's. */
+    IFT_RADON_COUNTER_REMOTE_BINS,
+    IFT_RADON_NCOUNTERS
+} iftRadonCounter;
+
+/** Current verbosity: 0 disables the statistics, 1 reports stage times and counters, 2 also reports
+    the number of calls of each stage and the sample throughput. Use iftSetRadonStatsVerbosity(). */
+extern int ift_radon_stats_verbosity;
+
+
+/**
+ * @brief Sets the verbosity of the statistics (0, 1 or 2).
+ */
+void iftSetRadonStatsVerbosity(int verbosity);
+
+/**
+ * @brief Clears all the timers and counters.
+ */
+void iftResetRadonStats(void);
+
+/**
+ * @brief Starts timing a stage: returns the current time, or 0 when the statistics are disabled.
+ */
+double iftRadonStatsTic(void);
+
+/**
+ * @brief Adds the time elapsed since tic (from iftRadonStatsTic()) to a stage.
+ */
+void iftRadonStatsToc(iftRadonStage stage, double tic);
+
+/**
+ * @brief Adds n to a counter (thread-safe).
+ */
+void iftRadonStatsCount(iftRadonCounter counter, long n);
+
+/**
+ * @brief Time (seconds) accumulated by a stage.
+ */
+double iftRadonStatsTime(iftRadonStage stage);
+
+/**
+ * @brief Value of a counter.
+ */
+long iftRadonStatsCounter(iftRadonCounter counter);
+
+/**
+ * @brief Statistics as Json: {"stages": {"<stage>": ms, ...}, "counters": {"<counter>": value, ...}},
+ * plus {"calls": {...}, "samples_per_second": ...} at verbosity 2.
+ */
+iftJson *iftRadonStatsToJson(void);
+
+/**
+ * @brief Writes the statistics to a .json file (see iftRadonStatsToJson()) or to a .csv file with the
+ * rows "type,name,value" (type is stage, calls or counter; stage times in ms).
+ */
+void iftWriteRadonStats(const char *path);
+
+/**
+ * @brief Parses the statistics options of a program and removes them from argv:
+ * "-v <verbosity>" (see iftSetRadonStatsVerbosity()) and "-o <file.json|file.csv>" (output of the statistics,
+ * verbosity 1 if not given). Without "-o", the statistics are printed as Json on exit by iftFinishRadonStats().
+ *
+ * @param argc Number of arguments (in/out).
+ * @param argv Arguments (in/out).
+ */
+void iftParseRadonStatsOptions(int *argc, char *argv[]);
+
+/**
+ * @brief Writes (or prints) the statistics as requested by iftParseRadonStatsOptions(), if enabled.
+ */
+void iftFinishRadonStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_STATS_H
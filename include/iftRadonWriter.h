@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @brief Asynchronous writer of the output images of the Radon transform programs.
+ *
+ * The images are pushed into a bounded queue and encoded (zlib compression of the PNGs) by a pool of
+ * encoder threads, so the computation goes on while the previous outputs are written. A push blocks only
+ * when the queue is full. With no encoder threads, every push writes the image in the calling thread.
+ */
+
+#ifndef IFT_RADON_WRITER_H
+#define IFT_RADON_WRITER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "iftImage.h"
+
+/** Default number of encoder threads. */
+#define IFT_RADON_WRITER_THREADS  2
+/** Default capacity (images) of the queue. */
+#define IFT_RADON_WRITER_CAPACITY 8
+
+/**
+ * @brief Asynchronous image writer (opaque).
+ */
+typedef struct ift_radon_writer iftRadonWriter;
+
+
+/**
+ * @brief Creates a writer and starts its encoder threads.
+ *
+ * @param nthreads Number of encoder threads (0 writes synchronously).
+ * @param capacity Maximum number of images waiting in the queue.
+ * @param visualization Whether the program should produce its visualization outputs (normalized and
+ * colored sinograms), see iftRadonWriterVisualization().
+ * @return The writer.
+ */
+iftRadonWriter *iftCreateRadonWriter(int nthreads, int capacity, bool visualization);
+
+/**
+ * @brief Writes the pending images, stops the encoder threads and destroys the writer.
+ */
+void iftDestroyRadonWriter(iftRadonWriter **writer);
+
+/**
+ * @brief Whether the visualization outputs are enabled. When they are not, the programs skip their
+ * normalization and color mapping as well.
+ */
+bool iftRadonWriterVisualization(const iftRadonWriter *writer);
+
+/**
+ * @brief Queues an image to be written by iftWriteImageByExt(). The writer takes the ownership of img,
+ * which is destroyed once written.
+ */
+void iftRadonWriterPushImage(iftRadonWriter *writer, iftImage *img, const char *path);
+
+/**
+ * @brief Queues an interleaved RGB buffer to be written by iftRadonWriteRGBPNG(). The writer takes the
+ * ownership of rgb, which is freed once written.
+ */
+void iftRadonWriterPushRGB(iftRadonWriter *writer, uchar *rgb, int xsize, int ysize, const char *path);
+
+/**
+ * @brief Parses the output options of a program, removes them from argv and creates the writer:
+ * "-j <encoder-threads>" (default IFT_RADON_WRITER_THREADS), "-q <queue-capacity>" (default
+ * IFT_RADON_WRITER_CAPACITY) and "-n" (no visualization output).
+ *
+ * @param argc Number of arguments (in/out).
+ * @param argv Arguments (in/out).
+ * @return The writer.
+ */
+iftRadonWriter *iftParseRadonWriterOptions(int *argc, char *argv[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IFT_RADON_WRITER_H
@@ -0,0 +1,248 @@
+#include "iftArena.h"
+
+#include <stdint.h>
+
+struct ift_arena_chunk {
+    iftArenaChunk *next;
+    size_t size;
+    size_t used;
+    char *buf;
+};
+
+
+static void *iftBumpBlock(char *buf, size_t size, size_t *used, size_t nbytes)
+{
+    uintptr_t start = (uintptr_t) (buf + *used);
+    size_t pad      = (IFT_ARENA_ALIGNMENT - (start % IFT_ARENA_ALIGNMENT)) % IFT_ARENA_ALIGNMENT;
+
+    if (*used + pad + nbytes > size)
+        return NULL;
+
+    void *block = buf + *used + pad;
+    *used += pad + nbytes;
+
+    return block;
+}
+
+
+static iftArenaChunk *iftCreateArenaChunk(iftArena *arena, size_t nbytes)
+{
+    iftArenaChunk *chunk = (iftArenaChunk *) iftAlloc(1, sizeof(iftArenaChunk));
+    chunk->size = nbytes + IFT_ARENA_ALIGNMENT;
+    chunk->buf  = (char *) iftAlloc(chunk->size, sizeof(char));
+    chunk->used = 0;
+    chunk->next = arena->overflow;
+    arena->overflow = chunk;
+    arena->nheap_allocs++;
+
+    return chunk;
+}
+
+
+iftArena *iftCreateArena(size_t size)
+{
+    iftArena *arena = (iftArena *) iftAlloc(1, sizeof(iftArena));
+
+    arena->size          = size;
+    arena->buf           = (size > 0) ? (char *) iftAlloc(size, sizeof(char)) : NULL;
+    arena->used          = 0;
+    arena->overflow      = NULL;
+    arena->overflow_used = 0;
+    arena->peak          = 0;
+    arena->nheap_allocs  = (size > 0) ? 1 : 0;
+
+    return arena;
+}
+
+
+void iftDestroyArena(iftArena **arena)
+{
+    if (arena == NULL || *arena == NULL)
+        return;
+
+    iftArenaChunk *chunk = (*arena)->overflow;
+    while (chunk != NULL) {
+        iftArenaChunk *next = chunk->next;
+        iftFree(chunk->buf);
+        iftFree(chunk);
+        chunk = next;
+    }
+    if ((*arena)->buf != NULL)
+        iftFree((*arena)->buf);
+    iftFree(*arena);
+    *arena = NULL;
+}
+
+
+void *iftArenaAlloc(iftArena *arena, size_t n, size_t sz)
+{
+    size_t nbytes = n * sz;
+    void *block   = NULL;
+
+    if (arena->buf != NULL)
+        block = iftBumpBlock(arena->buf, arena->size, &arena->used, nbytes);
+
+    if (block == NULL) {
+        iftArenaChunk *chunk = arena->overflow;
+        size_t used_before   = (chunk != NULL) ? chunk->used : 0;
+
+        if (chunk != NULL)
+            block = iftBumpBlock(chunk->buf, chunk->size, &chunk->used, nbytes);
+        if (block == NULL) {
+            /* chunks grow geometrically, so a cycle needs only a few of them */
+            size_t chunk_size = iftMax(nbytes, iftMax(arena->size, arena->overflow_used));
+            chunk       = iftCreateArenaChunk(arena, chunk_size);
+            used_before = 0;
+            block       = iftBumpBlock(chunk->buf, chunk->size, &chunk->used, nbytes);
+        }
+        arena->overflow_used += chunk->used - used_before;
+    }
+
+    arena->peak = iftMax(arena->peak, arena->used + arena->overflow_used);
+    memset(block, 0, nbytes);
+
+    return block;
+}
+
+
+void iftResetArena(iftArena *arena)
+{
+    if (arena->overflow != NULL) {
+        iftArenaChunk *chunk = arena->overflow;
+        while (chunk != NULL) {
+            iftArenaChunk *next = chunk->next;
+            iftFree(chunk->buf);
+            iftFree(chunk);
+            chunk = next;
+        }
+        arena->overflow = NULL;
+
+        /* one buffer with room for the peak usage, plus the alignment padding of the merged chunks */
+        if (arena->buf != NULL)
+            iftFree(arena->buf);
+        arena->size = arena->peak + 4 * IFT_ARENA_ALIGNMENT;
+        arena->buf  = (char *) iftAlloc(arena->size, sizeof(char));
+        arena->nheap_allocs++;
+    }
+
+    arena->used          = 0;
+    arena->overflow_used = 0;
+}
+
+
+iftMatrix *iftArenaCreateMatrix(iftArena *arena, int ncols, int nrows)
+{
+    iftMatrix *M = (iftMatrix *) iftArenaAlloc(arena, 1, sizeof(iftMatrix));
+
+    M->ncols     = ncols;
+    M->nrows     = nrows;
+    M->n         = (size_t) ncols * nrows;
+    M->val       = (float *) iftArenaAlloc(arena, M->n, sizeof(float));
+    M->tbrow     = (size_t *) iftArenaAlloc(arena, nrows, sizeof(size_t));
+    M->allocated = false;
+    for (int r = 0; r < nrows; r++)
+        M->tbrow[r] = (size_t) r * ncols;
+
+    return M;
+}
+
+
+iftMatrix *iftArenaTranslationMatrix(iftArena *arena, iftVector T)
+{
+    iftMatrix *A = iftArenaCreateMatrix(arena, 4, 4);
+
+    iftMatrixElem(A, 0, 0) = 1.0;
+    iftMatrixElem(A, 1, 1) = 1.0;
+    iftMatrixElem(A, 2, 2) = 1.0;
+    iftMatrixElem(A, 3, 3) = 1.0;
+    iftMatrixElem(A, 3, 0) = T.x;
+    iftMatrixElem(A, 3, 1) = T.y;
+    iftMatrixElem(A, 3, 2) = T.z;
+
+    return A;
+}
+
+
+iftMatrix *iftArenaRotationMatrix(iftArena *arena, char axis, float theta)
+{
+    iftMatrix *A = iftArenaCreateMatrix(arena, 4, 4);
+
+    theta = theta * IFT_PI / 180.0;
+    float cos_theta = cosf(theta);
+    float sin_theta = sinf(theta);
+
+    iftMatrixElem(A, 3, 3) = 1.0;
+    switch (axis) {
+        case IFT_AXIS_X:
+            iftMatrixElem(A, 0, 0) = 1.0;
+            iftMatrixElem(A, 1, 1) = cos_theta;
+            iftMatrixElem(A, 2, 1) = -sin_theta;
+            iftMatrixElem(A, 1, 2) = sin_theta;
+            iftMatrixElem(A, 2, 2) = cos_theta;
+            break;
+        case IFT_AXIS_Y:
+            iftMatrixElem(A, 0, 0) = cos_theta;
+            iftMatrixElem(A, 2, 0) = sin_theta;
+            iftMatrixElem(A, 1, 1) = 1.0;
+            iftMatrixElem(A, 0, 2) = -sin_theta;
+            iftMatrixElem(A, 2, 2) = cos_theta;
+            break;
+        case IFT_AXIS_Z:
+            iftMatrixElem(A, 0, 0) = cos_theta;
+            iftMatrixElem(A, 1, 0) = -sin_theta;
+            iftMatrixElem(A, 0, 1) = sin_theta;
+            iftMatrixElem(A, 1, 1) = cos_theta;
+            iftMatrixElem(A, 2, 2) = 1.0;
+            break;
+        default:
+            iftError("Invalid axis", "iftArenaRotationMatrix");
+    }
+
+    return A;
+}
+
+
+void iftMultMatricesInBuffer(const iftMatrix *A, const iftMatrix *B, iftMatrix *C)
+{
+    if ((A->ncols != B->nrows) || (C->nrows != A->nrows) || (C->ncols != B->ncols))
+        iftError("Cannot multiply matrices (%d,%d) * (%d,%d) into (%d,%d)", "iftMultMatricesInBuffer",
+                 A->nrows, A->ncols, B->nrows, B->ncols, C->nrows, C->ncols);
+
+    for (int r = 0; r < A->nrows; r++)
+        for (int c = 0; c < B->ncols; c++) {
+            float sum = 0.0;
+            for (int k = 0; k < A->ncols; k++)
+                sum += iftMatrixElem(A, k, r) * iftMatrixElem(B, c, k);
+            iftMatrixElem(C, c, r) = sum;
+        }
+}
+
+
+iftMatrix *iftArenaMultMatrices(iftArena *arena, const iftMatrix *A, const iftMatrix *B)
+{
+    iftMatrix *C = iftArenaCreateMatrix(arena, B->ncols, A->nrows);
+    iftMultMatricesInBuffer(A, B, C);
+
+    return C;
+}
+
+
+iftImage *iftArenaCreateImage(iftArena *arena, int xsize, int ysize, int zsize)
+{
+    iftImage *img = (iftImage *) iftArenaAlloc(arena, 1, sizeof(iftImage));
+
+    img->xsize = xsize;
+    img->ysize = ysize;
+    img->zsize = zsize;
+    img->dx    = img->dy = img->dz = 1.0;
+    img->n     = xsize * ysize * zsize;
+    img->val   = (int *) iftArenaAlloc(arena, img->n, sizeof(int));
+    img->tby   = (int *) iftArenaAlloc(arena, ysize, sizeof(int));
+    img->tbz   = (int *) iftArenaAlloc(arena, zsize, sizeof(int));
+    for (int y = 0; y < ysize; y++)
+        img->tby[y] = y * xsize;
+    for (int z = 0; z < zsize; z++)
+        img->tbz[z] = z * xsize * ysize;
+
+    return img;
+}
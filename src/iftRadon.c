@@ -0,0 +1,598 @@
+#include "iftRadonInternal.h"
+
+/* position of a pixel (x, y) used by the pixel-driven projector: (x + offset, y + offset). The ray-driven
+   projector truncates its ray origins, which shifts its rays by about half a pixel beyond the pixel centers */
+#define IFT_RADON_SPLAT_OFFSET 1.0
+
+/* minimum number of requested column angles to trace them on the transposed image */
+#define IFT_RADON_MIN_TRANSPOSED_ANGLES 16
+
+/* minimum number of requested angles (in bins) to trace the 8/16-bit images on a narrow copy of their pixels:
+   the copy pays off from about 4 angles of a 1024 x 1024 image */
+#define IFT_RADON_MIN_NARROW_ANGLES 4
+
+/* fixed-point units of the oversampled projector */
+#define IFT_RADON_Q32_ONE (1ULL << 32)
+
+
+/**
+ * @brief Pixels of the input image in the width of its kernel. i32 always points to the image values.
+ * The transposed copies (t suffix, ysize x xsize), when present, serve the column angles (see
+ * iftRadonIsColumnAngle()).
+ */
+typedef struct ift_radon_pixels {
+    iftRadonPixelType type;
+    uchar *u8, *u8t;
+    ushort *u16, *u16t;
+    int *i32, *i32t;
+    /* row offsets of the transposed image: tbyt[x] = x * ysize */
+    int *tbyt;
+} iftRadonPixels;
+
+
+/* this function creates the rotation/translation matrix for the given theta */
+static iftMatrix *iftRadonMatrix(int xsize, int ysize, int theta, iftArena *arena)
+{
+    iftVector v1 = {.x = (float)xsize / 2.0, .y = (float)ysize / 2.0, .z = 0.0};
+    iftMatrix *transMatrix1 = iftArenaTranslationMatrix(arena, v1);
+
+    iftMatrix *rotMatrix = iftArenaRotationMatrix(arena, IFT_AXIS_Z, theta);
+
+    float D = sqrt(xsize*xsize + ysize*ysize);
+    iftVector v2 = {.x = -(D / 2.0), .y = -(D / 2.0), .z = 0.0};
+    iftMatrix *transMatrix2 = iftArenaTranslationMatrix(arena, v2);
+
+    return iftArenaMultMatrices(arena, iftArenaMultMatrices(arena, transMatrix1, rotMatrix), transMatrix2);
+}
+
+
+/*
+ * Clips the line (x0, y0) + lamb * (Nx, Ny) against the image box [0, nx-1] x [0, ny-1] (Liang-Barsky): each
+ * axis bounds lamb to a slab, and the line is inside for the lamb between the largest entry and the smallest
+ * exit. An axis parallel to the line bounds nothing when the line is inside its slab, and everything
+ * otherwise. Written with selects only, so the loop over the rays of an angle has no branches.
+ */
+static inline int iftRadonClipRay(float x0, float y0, float Nx, float Ny, int nx, int ny, iftVoxel *p1, iftVoxel *pn)
+{
+    float tx0 = -x0 / Nx, tx1 = (nx - 1 - x0) / Nx;
+    float ty0 = -y0 / Ny, ty1 = (ny - 1 - y0) / Ny;
+    bool inside_x = (x0 >= 0) && (x0 <= nx - 1), inside_y = (y0 >= 0) && (y0 <= ny - 1);
+
+    float enter_x = (Nx != 0) ? fminf(tx0, tx1) : (inside_x ? -INFINITY : INFINITY);
+    float exit_x  = (Nx != 0) ? fmaxf(tx0, tx1) : (inside_x ? INFINITY : -INFINITY);
+    float enter_y = (Ny != 0) ? fminf(ty0, ty1) : (inside_y ? -INFINITY : INFINITY);
+    float exit_y  = (Ny != 0) ? fmaxf(ty0, ty1) : (inside_y ? INFINITY : -INFINITY);
+    float enter = fmaxf(enter_x, enter_y), exit = fminf(exit_x, exit_y);
+    int valid = (enter <= exit);
+
+    /* the endpoints are truncated, so rounding errors of a few ulps at the borders stay inside the image */
+    enter = valid ? enter : 0;
+    exit  = valid ? exit : 0;
+    iftVoxel u = {.x = iftMax(0, iftMin(nx - 1, (int) (x0 + enter * Nx))),
+                  .y = iftMax(0, iftMin(ny - 1, (int) (y0 + enter * Ny))), .z = 0};
+    iftVoxel v = {.x = iftMax(0, iftMin(nx - 1, (int) (x0 + exit * Nx))),
+                  .y = iftMax(0, iftMin(ny - 1, (int) (y0 + exit * Ny))), .z = 0};
+
+    /*
+     * The DDA excludes its last point, so the orientation of the rays is kept: the first point is the one on
+     * the border that comes first in the order y = 0, y = ny-1, x = 0, x = nx-1 (y wins at the corners), and
+     * the points are swapped when the first one is below and to the right of the other.
+     */
+    int enter_border = (enter_y >= enter_x) ? ((Ny > 0) ? 0 : 1) : ((Nx > 0) ? 2 : 3);
+    int exit_border  = (exit_y <= exit_x) ? ((Ny > 0) ? 1 : 0) : ((Nx > 0) ? 3 : 2);
+    bool first_is_u  = (enter_border <= exit_border);
+    iftVoxel a = first_is_u ? u : v, b = first_is_u ? v : u;
+    bool swap = (a.x > b.x) && (a.y > b.y);
+    iftVoxel none = {.x = -1, .y = -1, .z = 0};
+
+    *p1 = valid ? (swap ? b : a) : none;
+    *pn = valid ? (swap ? a : b) : none;
+
+    return valid;
+}
+
+
+void iftRadonComputeRays(int xsize, int ysize, int theta, int first, int nrays, iftRadonRay *rays, iftArena *arena)
+{
+    float D = sqrt(xsize*xsize + ysize*ysize);
+    iftMatrix *M = iftRadonMatrix(xsize, ysize, theta, arena);
+
+    /* direction of the rays: M * (0, 1, 0, 0) */
+    float Nx = iftMatrixElem(M, 1, 0), Ny = iftMatrixElem(M, 1, 1);
+
+    /* first point of each ray: Po = M * (p, -D/2, 0, 1), truncated to the pixel grid */
+    float bx = iftMatrixElem(M, 1, 0) * (-D / 2) + iftMatrixElem(M, 3, 0);
+    float by = iftMatrixElem(M, 1, 1) * (-D / 2) + iftMatrixElem(M, 3, 1);
+    for (int i = 0; i < nrays; i++) {
+        int x0 = iftMatrixElem(M, 0, 0) * (first + i) + bx;
+        int y0 = iftMatrixElem(M, 0, 1) * (first + i) + by;
+        rays[i].valid = iftRadonClipRay(x0, y0, Nx, Ny, xsize, ysize, &rays[i].p1, &rays[i].pn);
+    }
+}
+
+
+/*
+ * Pixels of the kernel of the image: a narrow copy for the 8/16-bit kernels when requested (otherwise their
+ * samples are read from the int32 pixels), and the transposed copy when requested.
+ */
+static iftRadonPixels iftRadonCreatePixels(const iftImage *img, bool narrow, bool transposed)
+{
+    iftRadonPixels pix = {.type = iftRadonNarrowestPixelType(img), .u8 = NULL, .u8t = NULL, .u16 = NULL,
+                          .u16t = NULL, .i32 = img->val, .i32t = NULL, .tbyt = NULL};
+
+    if (!narrow) {
+    } else if (pix.type == IFT_RADON_UINT8) {
+        pix.u8 = (uchar *) iftRadonAlloc(img->n, sizeof(uchar));
+        for (int p = 0; p < img->n; p++)
+            pix.u8[p] = img->val[p];
+    } else if (pix.type == IFT_RADON_UINT16) {
+        pix.u16 = (ushort *) iftRadonAlloc(img->n, sizeof(ushort));
+        for (int p = 0; p < img->n; p++)
+            pix.u16[p] = img->val[p];
+    }
+
+    if (transposed) {
+        pix.tbyt = (int *) iftRadonAlloc(img->xsize, sizeof(int));
+        for (int x = 0; x < img->xsize; x++)
+            pix.tbyt[x] = x * img->ysize;
+        if (pix.u8 != NULL) {
+            pix.u8t = (uchar *) iftRadonAlloc(img->n, sizeof(uchar));
+            iftRadonTranspose(pix.u8t, pix.u8, img->xsize, img->ysize);
+        } else if (pix.u16 != NULL) {
+            pix.u16t = (ushort *) iftRadonAlloc(img->n, sizeof(ushort));
+            iftRadonTranspose(pix.u16t, pix.u16, img->xsize, img->ysize);
+        } else {
+            pix.i32t = (int *) iftRadonAlloc(img->n, sizeof(int));
+            iftRadonTranspose(pix.i32t, pix.i32, img->xsize, img->ysize);
+        }
+    }
+
+    return pix;
+}
+
+
+static void iftRadonDestroyPixels(iftRadonPixels *pix)
+{
+    void *buffers[] = {pix->u8, pix->u16, pix->u8t, pix->u16t, pix->i32t, pix->tbyt};
+    for (int i = 0; i < 6; i++)
+        if (buffers[i] != NULL)
+            iftFree(buffers[i]);
+    pix->u8  = pix->u8t  = NULL;
+    pix->u16 = pix->u16t = NULL;
+    pix->i32t = pix->tbyt = NULL;
+}
+
+
+/* computes R(theta, first..first+nrays-1) from the rays of those bins */
+static void iftRadonTraceBins(const iftRadonPixels *pix, const iftImage *img, int theta, int first, int nrays,
+                              const iftRadonRay *rays, iftImage *R, iftArena *arena)
+{
+    iftRadonCountRays(rays, nrays);
+
+    double tic = iftRadonStatsTic();
+    int *out = &iftImgVal2D(R, theta, first);
+    bool transposed = (pix->tbyt != NULL) && iftRadonIsColumnAngle(theta);
+    uchar *u8      = transposed ? pix->u8t : pix->u8;
+    ushort *u16    = transposed ? pix->u16t : pix->u16;
+    int *i32       = transposed ? pix->i32t : pix->i32;
+    const int *tby = transposed ? pix->tbyt : img->tby;
+    if (transposed) {
+        iftRadonRay *trays = (iftRadonRay *) iftArenaAlloc(arena, nrays, sizeof(iftRadonRay));
+        iftRadonTransposeRays(rays, nrays, trays);
+        rays = trays;
+    }
+
+    if (u8 != NULL)
+        iftRadonProjectRays(u8, tby, rays, nrays, out, R->xsize);
+    else if (u16 != NULL)
+        iftRadonProjectRays(u16, tby, rays, nrays, out, R->xsize);
+    else if (iftRadonFixedStepFits(img->xsize, img->ysize))
+        iftRadonProjectRays(i32, tby, rays, nrays, out, R->xsize);
+    else
+        iftRadonProjectRays_i32f(i32, tby, rays, nrays, out, R->xsize);
+    iftRadonStatsToc(IFT_RADON_STAGE_TRAVERSAL, tic);
+}
+
+
+int iftRadonNumberOfBins(const iftImage *img)
+{
+    return (int) sqrt(img->xsize*img->xsize + img->ysize*img->ysize);
+}
+
+
+iftRadonPixelType iftRadonNarrowestPixelType(const iftImage *img)
+{
+    return iftRadonPixelTypeOf(img->val, img->n, img->xsize, img->ysize);
+}
+
+
+const char *iftRadonPixelTypeName(iftRadonPixelType type)
+{
+    switch (type) {
+        case IFT_RADON_UINT8:
+            return "uint8";
+        case IFT_RADON_UINT16:
+            return "uint16";
+        default:
+            return "int32";
+    }
+}
+
+
+int iftRadonRayEndpoints(const iftImage *img, int theta, int rho, iftVoxel *p1, iftVoxel *pn)
+{
+    iftArena *arena = iftCreateArena(0);
+    iftRadonRay ray;
+
+    iftRadonComputeRays(img->xsize, img->ysize, theta, rho, 1, &ray, arena);
+    iftRadonDestroyArena(&arena);
+    *p1 = ray.p1;
+    *pn = ray.pn;
+
+    return ray.valid;
+}
+
+
+iftImage *iftFastRadonTransform(const iftImage *img)
+{
+    iftBoundingBox all = {.begin = {0, 0, 0}, .end = {IFT_RADON_NANGLES - 1, iftRadonNumberOfBins(img) - 1, 0}};
+
+    return iftFastRadonTransformTiles(img, &all, 1);
+}
+
+
+iftImage *iftFastRadonTransformTiles(const iftImage *img, const iftBoundingBox *tiles, int ntiles)
+{
+    iftImage *R = iftCreateImage(IFT_RADON_NANGLES, iftRadonNumberOfBins(img), 1);
+
+    iftFastRadonTransformTilesInPlace(img, tiles, ntiles, R);
+
+    return R;
+}
+
+
+void iftFastRadonTransformTilesInPlace(const iftImage *img, const iftBoundingBox *tiles, int ntiles, iftImage *R)
+{
+    int nbins = iftRadonNumberOfBins(img);
+
+    if ((R->xsize != IFT_RADON_NANGLES) || (R->ysize != nbins))
+        iftError("Sinogram size (%d, %d) does not match the image: expected (%d, %d)",
+                 "iftFastRadonTransformTilesInPlace", R->xsize, R->ysize, IFT_RADON_NANGLES, nbins);
+
+    /* requested bins of each angle, so overlapping tiles are computed only once */
+    bool *requested = (bool *) iftRadonAlloc(IFT_RADON_NANGLES * nbins, sizeof(bool));
+    bool *angle_requested = (bool *) iftRadonAlloc(IFT_RADON_NANGLES, sizeof(bool));
+    for (int t = 0; t < ntiles; t++) {
+        if ((tiles[t].begin.x > tiles[t].end.x) || (tiles[t].begin.y > tiles[t].end.y))
+            iftError("Invalid tile %d: (%d, %d) - (%d, %d)", "iftFastRadonTransformTilesInPlace", t,
+                     tiles[t].begin.x, tiles[t].begin.y, tiles[t].end.x, tiles[t].end.y);
+
+        int theta_begin = iftMax(tiles[t].begin.x, 0), theta_end = iftMin(tiles[t].end.x, IFT_RADON_NANGLES - 1);
+        int rho_begin   = iftMax(tiles[t].begin.y, 0), rho_end   = iftMin(tiles[t].end.y, nbins - 1);
+        for (int theta = theta_begin; theta <= theta_end; theta++) {
+            for (int rho = rho_begin; rho <= rho_end; rho++)
+                requested[theta * nbins + rho] = true;
+            angle_requested[theta] |= (rho_begin <= rho_end);
+        }
+    }
+
+    /*
+     * The transposition costs about one traversed angle, so only many column angles make up for it. The narrow
+     * copy costs less, but small tiles are still cheaper to trace on the int32 pixels.
+     */
+    int ncolumn_angles = 0;
+    long nrequested = 0;
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++)
+        ncolumn_angles += angle_requested[theta] && iftRadonIsColumnAngle(theta);
+    for (long b = 0; b < (long) IFT_RADON_NANGLES * nbins; b++)
+        nrequested += requested[b];
+    iftRadonPixels pix = iftRadonCreatePixels(img, nrequested >= (long) IFT_RADON_MIN_NARROW_ANGLES * nbins,
+                                              ncolumn_angles >= IFT_RADON_MIN_TRANSPOSED_ANGLES);
+
+    /* scratch memory for the rays of each angle: after the first angle it never touches the heap */
+    iftArena *arena = iftCreateArena(0);
+
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        if (!angle_requested[theta])
+            continue;
+
+        iftResetArena(arena);
+        const bool *bins = &requested[theta * nbins];
+        for (int first = 0; first < nbins; ) {
+            if (!bins[first]) {
+                first++;
+                continue;
+            }
+            int last = first;
+            while ((last + 1 < nbins) && bins[last + 1])
+                last++;
+            int nrays = last - first + 1;
+
+            double tic = iftRadonStatsTic();
+            iftRadonRay *rays = (iftRadonRay *) iftArenaAlloc(arena, nrays, sizeof(iftRadonRay));
+            iftRadonComputeRays(img->xsize, img->ysize, theta, first, nrays, rays, arena);
+            iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+
+            iftRadonTraceBins(&pix, img, theta, first, nrays, rays, R, arena);
+            first = last + 1;
+        }
+    }
+
+    iftRadonDestroyArena(&arena);
+    iftRadonDestroyPixels(&pix);
+    iftFree(requested);
+    iftFree(angle_requested);
+}
+
+
+void iftUpdateFastRadonTransform(iftImage *R, const iftImage *prev, const iftImage *curr, iftBoundingBox dirty)
+{
+    if ((prev->xsize != curr->xsize) || (prev->ysize != curr->ysize))
+        iftError("Images have different sizes: (%d, %d) and (%d, %d)", "iftUpdateFastRadonTransform",
+                 prev->xsize, prev->ysize, curr->xsize, curr->ysize);
+
+    int nbins = iftRadonNumberOfBins(curr);
+    if ((R->xsize != IFT_RADON_NANGLES) || (R->ysize != nbins))
+        iftError("Sinogram size (%d, %d) does not match the image: expected (%d, %d)",
+                 "iftUpdateFastRadonTransform", R->xsize, R->ysize, IFT_RADON_NANGLES, nbins);
+
+    iftBoundingBox box = dirty;
+    box.begin.x = iftMax(box.begin.x, 0);
+    box.begin.y = iftMax(box.begin.y, 0);
+    box.end.x   = iftMin(box.end.x, curr->xsize - 1);
+    box.end.y   = iftMin(box.end.y, curr->ysize - 1);
+    box.begin.z = box.end.z = 0;
+    if ((box.begin.x > box.end.x) || (box.begin.y > box.end.y))
+        return;
+
+    /* the Radon transform is linear: R(curr) = R(prev) + R(curr - prev), and curr - prev is zero outside the box */
+    int bw = box.end.x - box.begin.x + 1, bh = box.end.y - box.begin.y + 1;
+    int *delta = (int *) iftRadonAlloc(bw * bh, sizeof(int));
+    for (int y = box.begin.y; y <= box.end.y; y++)
+        for (int x = box.begin.x; x <= box.end.x; x++)
+            delta[(x - box.begin.x) + (y - box.begin.y) * bw] = iftImgVal2D(curr, x, y) - iftImgVal2D(prev, x, y);
+
+    /* the stepping of the kernels depends on the image size only, so it is the same for prev and curr */
+    bool fixed_step = iftRadonFixedStepFits(curr->xsize, curr->ysize);
+    float D  = sqrt(curr->xsize*curr->xsize + curr->ysize*curr->ysize);
+    float cx = curr->xsize / 2.0, cy = curr->ysize / 2.0;
+    float corner_x[4] = {box.begin.x, box.end.x + 1, box.begin.x, box.end.x + 1};
+    float corner_y[4] = {box.begin.y, box.begin.y, box.end.y + 1, box.end.y + 1};
+
+    iftArena *arena = iftCreateArena(0);
+
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        iftResetArena(arena);
+
+        /* bins whose rays may cross the box: rho = D/2 + (x - cx) cos(theta) + (y - cy) sin(theta),
+           with a margin for the rounding of the ray endpoints */
+        float cos_theta = cos(theta * IFT_PI / 180.0), sin_theta = sin(theta * IFT_PI / 180.0);
+        float rho_min = IFT_INFINITY_FLT, rho_max = IFT_INFINITY_FLT_NEG;
+        for (int i = 0; i < 4; i++) {
+            float rho = D / 2.0 + (corner_x[i] - cx) * cos_theta + (corner_y[i] - cy) * sin_theta;
+            rho_min = iftMin(rho_min, rho);
+            rho_max = iftMax(rho_max, rho);
+        }
+        int first = iftMax(0, (int) floor(rho_min) - 2);
+        int last  = iftMin(nbins - 1, (int) ceil(rho_max) + 2);
+        if (first > last)
+            continue;
+
+        int nrays = last - first + 1;
+        double tic = iftRadonStatsTic();
+        iftRadonRay *rays = (iftRadonRay *) iftArenaAlloc(arena, nrays, sizeof(iftRadonRay));
+        iftRadonComputeRays(curr->xsize, curr->ysize, theta, first, nrays, rays, arena);
+        iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+
+        tic = iftRadonStatsTic();
+        for (int i = 0; i < nrays; i++) {
+            if (!rays[i].valid)
+                continue;
+            if (fixed_step)
+                iftImgVal2D(R, theta, first + i) += (int) iftRadonDDAInBox_i32(delta, &box, rays[i].p1, rays[i].pn);
+            else
+                iftImgVal2D(R, theta, first + i) += (int) iftRadonDDAInBox_i32f(delta, &box, rays[i].p1, rays[i].pn);
+        }
+        iftRadonStatsToc(IFT_RADON_STAGE_TRAVERSAL, tic);
+    }
+
+    iftRadonDestroyArena(&arena);
+    iftFree(delta);
+}
+
+
+iftImage *iftSparseRadonTransform(const iftImage *img)
+{
+    int nbins = iftRadonNumberOfBins(img);
+    iftImage *R = iftCreateImage(IFT_RADON_NANGLES, nbins, 1);
+    float D  = sqrt(img->xsize*img->xsize + img->ysize*img->ysize);
+    float cx = img->xsize / 2.0, cy = img->ysize / 2.0;
+
+    /* non-zero pixels */
+    int m = 0;
+    for (int p = 0; p < img->n; p++)
+        m += (img->val[p] != 0);
+    int *pix_x = (int *) iftRadonAlloc(iftMax(m, 1), sizeof(int)), *pix_y = (int *) iftRadonAlloc(iftMax(m, 1), sizeof(int));
+    int *pix_val = (int *) iftRadonAlloc(iftMax(m, 1), sizeof(int));
+    for (int p = 0, i = 0; p < img->n; p++)
+        if (img->val[p] != 0) {
+            pix_x[i]   = p % img->xsize;
+            pix_y[i]   = p / img->xsize;
+            pix_val[i] = img->val[p];
+            i++;
+        }
+
+    /* per-angle tables: rho(x, y) = proj_x[x] + proj_y[y] */
+    float *proj_x = (float *) iftRadonAlloc(img->xsize, sizeof(float));
+    float *proj_y = (float *) iftRadonAlloc(img->ysize, sizeof(float));
+    long *acc = (long *) iftRadonAlloc(nbins, sizeof(long));
+
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        double tic = iftRadonStatsTic();
+        double cos_theta = cos(theta * IFT_PI / 180.0), sin_theta = sin(theta * IFT_PI / 180.0);
+        for (int x = 0; x < img->xsize; x++)
+            proj_x[x] = D / 2.0 + cos_theta * (x + IFT_RADON_SPLAT_OFFSET - cx);
+        for (int y = 0; y < img->ysize; y++)
+            proj_y[y] = sin_theta * (y + IFT_RADON_SPLAT_OFFSET - cy);
+        iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+
+        /* splat each pixel into the bin of its sinusoid */
+        tic = iftRadonStatsTic();
+        memset(acc, 0, nbins * sizeof(long));
+        for (int i = 0; i < m; i++) {
+            int bin = (int) floorf(proj_x[pix_x[i]] + proj_y[pix_y[i]]);
+            if ((bin >= 0) && (bin < nbins))
+                acc[bin] += pix_val[i];
+        }
+
+        /* the DDA takes one sample per unit step along the major axis of the ray, i.e.,
+           max(|cos|, |sin|) samples per unit length, while a splat counts each pixel once */
+        double weight = iftMax(fabs(cos_theta), fabs(sin_theta));
+        for (int bin = 0; bin < nbins; bin++)
+            iftImgVal2D(R, theta, bin) = iftRound(acc[bin] * weight);
+        iftRadonStatsToc(IFT_RADON_STAGE_TRAVERSAL, tic);
+    }
+
+    iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, (long) m * IFT_RADON_NANGLES);
+    iftFree(pix_x);
+    iftFree(pix_y);
+    iftFree(pix_val);
+    iftFree(proj_x);
+    iftFree(proj_y);
+    iftFree(acc);
+
+    return R;
+}
+
+
+/*
+ * Sum of the nsubrays sub-rays of a clipped ray, times nsubrays. The sub-rays are the ray shifted along its minor
+ * axis by their offsets within the bin, so they take the DDA samples of the ray (one per pixel of the major axis,
+ * in Q16.16 positions), each at its own minor position: first + s * h for the sub-ray s. The sub-rays of a sample
+ * fall into the npix pixels u, u + 1, ... (npix <= 3, since they span less than 1 / |n_major| <= sqrt(2) pixels),
+ * where u is the pixel of the first sub-ray; instead of sampling each sub-ray, the pixels are weighted by the
+ * number of sub-rays inside them, from the number of sub-rays before each pixel border, ceil(distance / h). Sub-rays
+ * beyond the border of the image read its border pixel, as the endpoints of the ray are clamped to the image.
+ */
+static inline int64_t iftRadonSubRaySums(const int *val, int major_stride, int minor_stride, int nminor, int64_t q,
+                                         int64_t dq, int nsamples, int nsubrays, int npix, uint64_t h_inv)
+{
+    int64_t acc = 0;
+
+    for (int k = 0; k < nsamples; k++, q += dq) {
+        const int *line = &val[k * major_stride];
+        int u = (int) (q >> IFT_RADON_Q16_SHIFT);
+        uint64_t rem = ((int64_t) (u + 1) << IFT_RADON_Q16_SHIFT) - q;
+        int c1 = nsubrays, c2 = nsubrays;
+        if (npix > 1)
+            c1 = iftMin(nsubrays, (int) ((rem * h_inv + IFT_RADON_Q32_ONE - 1) >> 32));
+        if (npix > 2)
+            c2 = iftMin(nsubrays, (int) (((rem + IFT_RADON_Q16_ONE) * h_inv + IFT_RADON_Q32_ONE - 1) >> 32));
+        int w[3] = {c1, c2 - c1, nsubrays - c2};
+
+        if ((u >= 0) && (u + npix <= nminor))
+            for (int i = 0; i < npix; i++)
+                acc += (int64_t) w[i] * line[(u + i) * minor_stride];
+        else
+            for (int i = 0; i < npix; i++)
+                acc += (int64_t) w[i] * line[iftMax(0, iftMin(nminor - 1, u + i)) * minor_stride];
+    }
+
+    return acc;
+}
+
+
+iftImage *iftOversampledRadonTransform(const iftImage *img, int nsubrays)
+{
+    if ((nsubrays < 1) || (nsubrays > IFT_RADON_MAX_SUBRAYS))
+        iftError("Invalid number of sub-rays: %d (it must be in [1, %d])", "iftOversampledRadonTransform",
+                 nsubrays, IFT_RADON_MAX_SUBRAYS);
+
+    int nbins = iftRadonNumberOfBins(img);
+    iftImage *R = iftCreateImage(IFT_RADON_NANGLES, nbins, 1);
+    iftRadonRay *rays = (iftRadonRay *) iftRadonAlloc(nbins, sizeof(iftRadonRay));
+    iftArena *arena = iftCreateArena(0);
+    long nsamples = 0;
+
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        double tic = iftRadonStatsTic();
+        iftResetArena(arena);
+        iftRadonComputeRays(img->xsize, img->ysize, theta, 0, nbins, rays, arena);
+        float Nx = -sin(theta * IFT_PI / 180.0), Ny = cos(theta * IFT_PI / 180.0);
+        iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+
+        tic = iftRadonStatsTic();
+        for (int p = 0; p < nbins; p++) {
+            const iftRadonRay *ray = &rays[p];
+            if (!ray->valid)
+                continue;
+
+            /* the DDA of the ray, along its major axis; a ray of a single pixel has that pixel as its only sample */
+            int Dx = ray->pn.x - ray->p1.x, Dy = ray->pn.y - ray->p1.y;
+            bool major_x = ((Dx != 0) || (Dy != 0)) ? (abs(Dx) >= abs(Dy)) : (fabsf(Nx) >= fabsf(Ny));
+            int n = iftMax(abs(Dx), abs(Dy)) + 1, nsamples_ray = iftMax(n - 1, 1);
+            int64_t dq = 0;
+            if (n > 1)
+                dq = major_x ? ((int64_t) Dy * IFT_RADON_Q16_ONE) / abs(Dx) : ((int64_t) Dx * IFT_RADON_Q16_ONE) / abs(Dy);
+            int step = major_x ? iftRadonSign(Dx) : iftRadonSign(Dy);
+
+            /* the sub-rays s = 0..nsubrays-1 are at the offsets (s + 0.5) / nsubrays - 0.5 of the bin, i.e.,
+               h = 1 / (nsubrays |n_major|) pixels apart along the minor axis, around the ray */
+            double h = IFT_RADON_Q16_ONE / (fmax(fabsf(major_x ? Nx : Ny), 0.5) * nsubrays);
+            double span = (nsubrays - 1) * h;
+            int npix = (nsubrays == 1) ? 1 : (span < IFT_RADON_Q16_ONE) ? 2 : 3;
+            uint64_t h_inv = (nsubrays > 1) ? (uint64_t) llround(IFT_RADON_Q32_ONE / h) : 0;
+            int64_t q = (int64_t) (major_x ? ray->p1.y : ray->p1.x) * IFT_RADON_Q16_ONE - llround(span / 2);
+
+            /* the pixel of the sample k at the minor coordinate u is val[k * major_stride + u * minor_stride] */
+            int major_stride = major_x ? step : step * img->xsize, minor_stride = major_x ? img->xsize : 1;
+            int nminor = major_x ? img->ysize : img->xsize;
+            const int *val = &img->val[major_x ? ray->p1.x : ray->p1.y * img->xsize];
+
+            /* npix is passed as a constant, so each case gets its own loop */
+            int64_t acc;
+            if (npix == 1)
+                acc = iftRadonSubRaySums(val, major_stride, minor_stride, nminor, q, dq, nsamples_ray, 1, 1, 0);
+            else if (npix == 2)
+                acc = iftRadonSubRaySums(val, major_stride, minor_stride, nminor, q, dq, nsamples_ray, nsubrays, 2, h_inv);
+            else
+                acc = iftRadonSubRaySums(val, major_stride, minor_stride, nminor, q, dq, nsamples_ray, nsubrays, 3, h_inv);
+            nsamples += nsamples_ray;
+            /* the mean of the sub-rays, rounded half away from zero (exact for a single sub-ray) */
+            iftImgVal2D(R, theta, p) = (int) ((acc >= 0) ? (acc + nsubrays / 2) / nsubrays :
+                                                           -((-acc + nsubrays / 2) / nsubrays));
+        }
+        iftRadonStatsToc(IFT_RADON_STAGE_TRAVERSAL, tic);
+    }
+
+    iftRadonStatsCount(IFT_RADON_COUNTER_RAYS, (long) IFT_RADON_NANGLES * nbins * nsubrays);
+    iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, nsamples);
+    iftRadonDestroyArena(&arena);
+    iftFree(rays);
+
+    return R;
+}
+
+
+float iftRadonDensity(const iftImage *img)
+{
+    int m = 0;
+    for (int p = 0; p < img->n; p++)
+        m += (img->val[p] != 0);
+
+    return (float) m / img->n;
+}
+
+
+iftRadonMethod iftRadonSelectMethod(const iftImage *img)
+{
+    return (iftRadonDensity(img) < IFT_RADON_SPARSE_DENSITY) ? IFT_RADON_PIXEL_DRIVEN : IFT_RADON_RAY_DRIVEN;
+}
+
+
+iftImage *iftRadonTransform(const iftImage *img, iftRadonMethod method)
+{
+    if (method == IFT_RADON_PIXEL_DRIVEN)
+        return iftSparseRadonTransform(img);
+    return iftFastRadonTransform(img);
+}
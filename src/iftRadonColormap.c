@@ -0,0 +1,59 @@
+#include "iftRadonColormap.h"
+#include <png.h>
+
+
+iftRadonColormap iftRadonHotIronColormap(void)
+{
+    iftRadonColormap cmap;
+    iftColorTable *ctb = iftCreateHotIronColorTable(256);
+
+    for (int i = 0; i < 256; i++)
+        for (int c = 0; c < 3; c++)
+            cmap.rgb[i][c] = iftMax(0, iftMin(255, ctb->color[i].val[c]));
+    iftDestroyColorTable(&ctb);
+
+    return cmap;
+}
+
+
+uchar *iftRadonApplyColormap(const iftImage *img, const iftRadonColormap *cmap)
+{
+    uchar *rgb = iftAllocUCharArray(3 * img->n);
+
+    /* branch-free body: clamp, then three table loads and stores per pixel */
+    for (int p = 0; p < img->n; p++) {
+        int v = iftMax(0, iftMin(255, img->val[p]));
+        rgb[3 * p]     = cmap->rgb[v][0];
+        rgb[3 * p + 1] = cmap->rgb[v][1];
+        rgb[3 * p + 2] = cmap->rgb[v][2];
+    }
+
+    return rgb;
+}
+
+
+void iftRadonWriteRGBPNG(const uchar *rgb, int xsize, int ysize, const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+        iftError("Cannot open file: %s", "iftRadonWriteRGBPNG", path);
+
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info  = (png != NULL) ? png_create_info_struct(png) : NULL;
+    if ((png == NULL) || (info == NULL))
+        iftError("Cannot write the PNG: %s", "iftRadonWriteRGBPNG", path);
+    /* setjmp may only be the whole controlling expression of an if */
+    if (setjmp(png_jmpbuf(png)))
+        iftError("Cannot write the PNG: %s", "iftRadonWriteRGBPNG", path);
+
+    png_init_io(png, fp);
+    png_set_IHDR(png, info, xsize, ysize, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+    for (int y = 0; y < ysize; y++)
+        png_write_row(png, (png_const_bytep) &rgb[3 * y * xsize]);
+    png_write_end(png, NULL);
+
+    png_destroy_write_struct(&png, &info);
+    fclose(fp);
+}
@@ -0,0 +1,246 @@
+#include "iftRadonDescriptor.h"
+#include "iftRadonPlan.h"
+#include "iftRadonInternal.h"
+
+
+/* DFT basis of the descriptor: computed once and shared by all the samples of a batch */
+typedef struct {
+    int nfeats;
+    double *cos, *sin;    /* [k * IFT_RADON_NANGLES + theta], k = 0..nfeats */
+} iftRadonSignaturePlan;
+
+
+static iftRadonSignaturePlan iftCreateRadonSignaturePlan(int nfeats)
+{
+    if ((nfeats < 1) || (nfeats > IFT_RADON_SIGNATURE_MAX_FEATS))
+        iftError("Invalid number of features: %d (it must be in [1, %d])", "iftCreateRadonSignaturePlan",
+                 nfeats, IFT_RADON_SIGNATURE_MAX_FEATS);
+
+    iftRadonSignaturePlan plan;
+    plan.nfeats = nfeats;
+    plan.cos    = iftAllocDoubleArray((nfeats + 1) * IFT_RADON_NANGLES);
+    plan.sin    = iftAllocDoubleArray((nfeats + 1) * IFT_RADON_NANGLES);
+
+    for (int k = 0; k <= nfeats; k++)
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            double a = 2.0 * IFT_PI * ((k * theta) % IFT_RADON_NANGLES) / IFT_RADON_NANGLES;
+            plan.cos[k * IFT_RADON_NANGLES + theta] = cos(a);
+            plan.sin[k * IFT_RADON_NANGLES + theta] = sin(a);
+        }
+
+    return plan;
+}
+
+
+static void iftDestroyRadonSignaturePlan(iftRadonSignaturePlan *plan)
+{
+    iftFree(plan->cos);
+    iftFree(plan->sin);
+}
+
+
+/* size of an image of a batch, to group the images of the same size */
+typedef struct {
+    int xsize, ysize, s;
+} iftRadonSignatureImage;
+
+
+static int iftRadonSignatureCompareSizes(const void *a, const void *b)
+{
+    const iftRadonSignatureImage *ia = a, *ib = b;
+
+    if (ia->ysize != ib->ysize)
+        return (ia->ysize < ib->ysize) ? -1 : 1;
+    if (ia->xsize != ib->xsize)
+        return (ia->xsize < ib->xsize) ? -1 : 1;
+    return ia->s - ib->s;
+}
+
+
+static inline bool iftRadonSignatureSameSize(const iftRadonSignatureImage *a, const iftRadonSignatureImage *b)
+{
+    return (a->xsize == b->xsize) && (a->ysize == b->ysize);
+}
+
+
+static void iftRadonSignatureFeatures(const iftImage *R, const iftRadonSignaturePlan *plan, float *feat)
+{
+    double *r   = iftRadonSignature(R);
+    double mag0 = 0;
+
+    for (int k = 0; k <= plan->nfeats; k++) {
+        const double *c = &plan->cos[k * IFT_RADON_NANGLES], *s = &plan->sin[k * IFT_RADON_NANGLES];
+        double re = 0, im = 0;
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            re += r[theta] * c[theta];
+            im -= r[theta] * s[theta];
+        }
+
+        double mag = sqrt(re * re + im * im);
+        if (k == 0)
+            mag0 = mag;
+        else
+            feat[k - 1] = (mag0 > 0) ? mag / mag0 : 0;
+    }
+
+    iftFree(r);
+}
+
+
+double *iftRadonSignature(const iftImage *R)
+{
+    if (R->xsize != IFT_RADON_NANGLES)
+        iftError("Invalid sinogram: %d columns instead of %d", "iftRadonSignature", R->xsize, IFT_RADON_NANGLES);
+
+    double *r = iftAllocDoubleArray(R->xsize);
+
+    for (int rho = 0; rho < R->ysize; rho++)
+        for (int theta = 0; theta < R->xsize; theta++) {
+            double v = iftImgVal2D(R, theta, rho);
+            r[theta] += v * v;
+        }
+
+    /* the DDA takes max(|cos|, |sin|) samples per unit length: without this correction the signatures
+       of all images would peak at the same angles */
+    for (int theta = 0; theta < R->xsize; theta++) {
+        double a = theta * IFT_PI / 180.0;
+        double w = iftMax(fabs(cos(a)), fabs(sin(a)));
+        r[theta] /= w * w;
+    }
+
+    return r;
+}
+
+
+float *iftRadonSignatureDescriptor(const iftImage *img, int nfeats)
+{
+    iftRadonSignaturePlan plan = iftCreateRadonSignaturePlan(nfeats);
+    float *feat = iftAllocFloatArray(nfeats);
+    iftImage *R = iftFastRadonTransform(img);
+
+    iftRadonSignatureFeatures(R, &plan, feat);
+    iftDestroyImage(&R);
+    iftDestroyRadonSignaturePlan(&plan);
+
+    return feat;
+}
+
+
+iftDataSet *iftRadonSignatureDataSet(iftImage **imgs, int nimgs, int nfeats)
+{
+    iftRadonSignaturePlan plan = iftCreateRadonSignaturePlan(nfeats);
+    iftDataSet *Z = iftCreateDataSet(nimgs, nfeats);
+
+    /* images ordered by size: the images of each size are consecutive */
+    iftRadonSignatureImage *order = (iftRadonSignatureImage *) iftAlloc(nimgs, sizeof(iftRadonSignatureImage));
+    for (int s = 0; s < nimgs; s++) {
+        order[s].xsize = imgs[s]->xsize;
+        order[s].ysize = imgs[s]->ysize;
+        order[s].s     = s;
+        Z->sample[s].id = s;
+    }
+    qsort(order, nimgs, sizeof(iftRadonSignatureImage), iftRadonSignatureCompareSizes);
+
+    int *single = iftAllocIntArray(nimgs), nsingle = 0;
+    for (int i = 0, j; i < nimgs; i = j) {
+        for (j = i + 1; (j < nimgs) && iftRadonSignatureSameSize(&order[i], &order[j]); j++);
+        if (j - i == 1)
+            single[nsingle++] = order[i].s;
+    }
+
+    /* an image of a size of its own costs a transform anyway: the images run in parallel */
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < nsingle; i++) {
+        iftImage *R = iftFastRadonTransform(imgs[single[i]]);
+        iftRadonSignatureFeatures(R, &plan, Z->sample[single[i]].feat);
+        iftDestroyImage(&R);
+    }
+
+    /* the images of the same size share the plan of the size, executed on batches of images */
+    for (int i = 0, j; i < nimgs; i = j) {
+        for (j = i + 1; (j < nimgs) && iftRadonSignatureSameSize(&order[i], &order[j]); j++);
+        if (j - i == 1)
+            continue;
+
+        iftRadonPlan *rplan = iftCreateRadonPlan(order[i].xsize, order[i].ysize);
+        for (int b = i; b < j; b += IFT_RADON_BATCH) {
+            int nbatch = iftMin(IFT_RADON_BATCH, j - b);
+            const int *in[IFT_RADON_BATCH];
+            int *out[IFT_RADON_BATCH];
+            iftImage *R[IFT_RADON_BATCH];
+            for (int k = 0; k < nbatch; k++) {
+                in[k]  = imgs[order[b + k].s]->val;
+                R[k]   = iftCreateImage(IFT_RADON_NANGLES, iftRadonPlanNumberOfBins(rplan), 1);
+                out[k] = R[k]->val;
+            }
+
+            iftExecuteRadonPlanBatch(rplan, in, nbatch, out);
+
+            #pragma omp parallel for
+            for (int k = 0; k < nbatch; k++) {
+                iftRadonSignatureFeatures(R[k], &plan, Z->sample[order[b + k].s].feat);
+                iftDestroyImage(&R[k]);
+            }
+        }
+        iftDestroyRadonPlan(&rplan);
+    }
+
+    iftFree(single);
+    iftFree(order);
+    iftDestroyRadonSignaturePlan(&plan);
+
+    return Z;
+}
+
+
+iftDataSet *iftRadonSignatureDataSetFromLabels(const iftImage *label, int nfeats)
+{
+    int nlabels = iftMaximumValue(label);
+    if (nlabels < 1)
+        iftError("The label image has no regions", "iftRadonSignatureDataSetFromLabels");
+
+    /* bounding boxes of all regions in one pass */
+    iftBoundingBox *bb = (iftBoundingBox *) iftAlloc(nlabels + 1, sizeof(iftBoundingBox));
+    for (int l = 1; l <= nlabels; l++) {
+        bb[l].begin.x = label->xsize;
+        bb[l].begin.y = label->ysize;
+        bb[l].end.x = bb[l].end.y = -1;
+    }
+    for (int p = 0; p < label->n; p++) {
+        int l = label->val[p];
+        if (l <= 0)
+            continue;
+        int x = p % label->xsize, y = (p / label->xsize) % label->ysize;
+        bb[l].begin.x = iftMin(bb[l].begin.x, x);
+        bb[l].begin.y = iftMin(bb[l].begin.y, y);
+        bb[l].end.x   = iftMax(bb[l].end.x, x);
+        bb[l].end.y   = iftMax(bb[l].end.y, y);
+    }
+
+    iftRadonSignaturePlan plan = iftCreateRadonSignaturePlan(nfeats);
+    iftDataSet *Z = iftCreateDataSet(nlabels, nfeats);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int l = 1; l <= nlabels; l++) {
+        Z->sample[l - 1].id = l;
+        if (bb[l].end.x < 0)
+            continue;
+
+        /* binary mask of the region, cropped to its bounding box */
+        iftImage *mask = iftCreateImage(bb[l].end.x - bb[l].begin.x + 1, bb[l].end.y - bb[l].begin.y + 1, 1);
+        for (int y = bb[l].begin.y; y <= bb[l].end.y; y++)
+            for (int x = bb[l].begin.x; x <= bb[l].end.x; x++)
+                if (iftImgVal2D(label, x, y) == l)
+                    iftImgVal2D(mask, x - bb[l].begin.x, y - bb[l].begin.y) = 1;
+
+        iftImage *R = iftFastRadonTransform(mask);
+        iftRadonSignatureFeatures(R, &plan, Z->sample[l - 1].feat);
+        iftDestroyImage(&R);
+        iftDestroyImage(&mask);
+    }
+
+    iftDestroyRadonSignaturePlan(&plan);
+    iftFree(bb);
+
+    return Z;
+}
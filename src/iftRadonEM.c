@@ -0,0 +1,387 @@
+#include "iftRadonEM.h"
+#include "iftRadonInternal.h"
+
+/* bins of the rays handed out at once to the threads of an update */
+#define IFT_RADON_EM_CHUNK 64
+
+
+struct ift_radon_em {
+    int xsize, ysize, nbins, nsubsets;
+    /** Row offsets of the images: tby[y] = y * xsize. */
+    int *tby;
+    /** Clipped ray of each bin: rays[theta * nbins + rho]. */
+    iftRadonRay *rays;
+    /** Inverse of the sensitivity image of each subset (inv_sens[s * n + p]), 0 where no ray of s passes. */
+    float *inv_sens;
+    /** Samples of all the rays: the sum of the sensitivity images. */
+    long nsamples;
+    int nthreads;
+    /** Back-projection of the ratios (n values, zero between the updates): each thread owns a band of rows. */
+    float *bp;
+    /** Ratio of the measured to the projected counts of each ray of a subset. */
+    float *ratio;
+    /** Number and total time (s) of the subset updates. */
+    long nupdates;
+    double update_time;
+};
+
+
+/*
+ * Fixed-point DDA of a ray, with the samples of iftRadonDDA(): n - 1 samples from (px, py) by (dx, dy). A ray of a single pixel has that pixel as its only sample.
+ */
+static inline int iftRadonEMStartRay(const iftRadonRay *ray, int32_t *px, int32_t *py, int32_t *dx, int32_t *dy)
+{
+    int Dx = ray->pn.x - ray->p1.x, Dy = ray->pn.y - ray->p1.y, n;
+
+    *px = ray->p1.x * IFT_RADON_Q16_ONE;
+    *py = ray->p1.y * IFT_RADON_Q16_ONE;
+    if (Dx == 0 && Dy == 0) {
+        *dx = *dy = 0;
+        n = 2;
+    } else if (abs(Dx) >= abs(Dy)) {
+        n   = abs(Dx) + 1;
+        *dx = iftRadonSign(Dx) * IFT_RADON_Q16_ONE;
+        *dy = (int32_t) (((int64_t) Dy * IFT_RADON_Q16_ONE) / abs(Dx));
+    } else {
+        n   = abs(Dy) + 1;
+        *dy = iftRadonSign(Dy) * IFT_RADON_Q16_ONE;
+        *dx = (int32_t) (((int64_t) Dx * IFT_RADON_Q16_ONE) / abs(Dy));
+    }
+
+    return n;
+}
+
+
+/* sum of the pixels of x along a ray */
+static inline float iftRadonEMProjectRay(const float *x, const int *tby, const iftRadonRay *ray)
+{
+    int32_t px, py, dx, dy;
+    int n = iftRadonEMStartRay(ray, &px, &py, &dx, &dy);
+    float J = 0;
+
+    for (int k = 1; k < n; k++) {
+        J += x[(px >> IFT_RADON_Q16_SHIFT) + tby[py >> IFT_RADON_Q16_SHIFT]];
+        px += dx;
+        py += dy;
+    }
+
+    return J;
+}
+
+
+/* floor(a / b) for b > 0 */
+static inline int64_t iftRadonEMFloorDiv(int64_t a, int64_t b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+
+/*
+ * Adds v to the pixels of buf along a ray, only in the rows [y0, y1): the transpose of iftRadonEMProjectRay()
+ * restricted to a band. The fixed-point positions do not drift, so the samples in the band (a range of k,
+ * since the rows change monotonically along the ray) are visited directly at the same positions.
+ */
+static inline void iftRadonEMBackProjectRay(float *buf, const int *tby, const iftRadonRay *ray, float v, int y0, int y1)
+{
+    int32_t px, py, dx, dy;
+    int n = iftRadonEMStartRay(ray, &px, &py, &dx, &dy);
+
+    /* samples k = 0..n-2 at row (py + k * dy) >> 16, inside the band when y0 * ONE <= py + k * dy < y1 * ONE */
+    int64_t lo = (int64_t) y0 * IFT_RADON_Q16_ONE - py, hi = (int64_t) y1 * IFT_RADON_Q16_ONE - 1 - py;
+    int64_t kmin = 0, kmax = n - 2;
+    if (dy > 0) {
+        kmin = iftMax(kmin, -iftRadonEMFloorDiv(-lo, dy));
+        kmax = iftMin(kmax, iftRadonEMFloorDiv(hi, dy));
+    } else if (dy < 0) {
+        kmin = iftMax(kmin, -iftRadonEMFloorDiv(hi, -dy));
+        kmax = iftMin(kmax, iftRadonEMFloorDiv(-lo, -dy));
+    } else if ((lo > 0) || (hi < 0))
+        return;
+
+    px += (int32_t) kmin * dx;
+    py += (int32_t) kmin * dy;
+    for (int64_t k = kmin; k <= kmax; k++) {
+        buf[(px >> IFT_RADON_Q16_SHIFT) + tby[py >> IFT_RADON_Q16_SHIFT]] += v;
+        px += dx;
+        py += dy;
+    }
+}
+
+
+/* band of rows of thread t of nthreads */
+static inline void iftRadonEMBand(const iftRadonEM *em, int t, int nthreads, int *y0, int *y1)
+{
+    *y0 = (int) ((long) em->ysize * t / nthreads);
+    *y1 = (int) ((long) em->ysize * (t + 1) / nthreads);
+}
+
+
+/* number of angles of the subset s: theta = s, s + nsubsets, ... */
+static inline int iftRadonEMSubsetAngles(const iftRadonEM *em, int s)
+{
+    return (IFT_RADON_NANGLES - s + em->nsubsets - 1) / em->nsubsets;
+}
+
+
+/* ray of the i-th bin of the subset s, and its sinogram index */
+static inline const iftRadonRay *iftRadonEMSubsetRay(const iftRadonEM *em, int s, long i, long *bin)
+{
+    int theta = s + (int) (i / em->nbins) * em->nsubsets, rho = (int) (i % em->nbins);
+
+    *bin = (long) rho * IFT_RADON_NANGLES + theta;
+    return &em->rays[(long) theta * em->nbins + rho];
+}
+
+
+/* back-projects ones along the rays of each subset, and keeps the inverse of the sums */
+static void iftRadonEMComputeSensitivity(iftRadonEM *em)
+{
+    long n = (long) em->xsize * em->ysize;
+    long nsamples = 0;
+
+    for (int s = 0; s < em->nsubsets; s++) {
+        double tic = iftRadonStatsTic();
+        float *sens = &em->inv_sens[s * n];
+        long nrays = (long) iftRadonEMSubsetAngles(em, s) * em->nbins;
+
+        #pragma omp parallel num_threads(em->nthreads) reduction(+:nsamples)
+        {
+            int y0, y1;
+            iftRadonEMBand(em, omp_get_thread_num(), omp_get_num_threads(), &y0, &y1);
+
+            for (long i = 0; i < nrays; i++) {
+                long bin;
+                const iftRadonRay *ray = iftRadonEMSubsetRay(em, s, i, &bin);
+                if (ray->valid)
+                    iftRadonEMBackProjectRay(sens, em->tby, ray, 1, y0, y1);
+            }
+
+            for (long p = (long) y0 * em->xsize; p < (long) y1 * em->xsize; p++) {
+                nsamples += (long) sens[p];
+                sens[p] = (sens[p] > 0) ? 1 / sens[p] : 0;
+            }
+        }
+        iftRadonStatsToc(IFT_RADON_STAGE_BACKPROJECTION, tic);
+    }
+
+    em->nsamples = nsamples;
+}
+
+
+iftRadonEM *iftCreateRadonEM(int xsize, int ysize, int nsubsets)
+{
+    if ((xsize <= 0) || (ysize <= 0))
+        iftError("Invalid image size: (%d, %d)", "iftCreateRadonEM", xsize, ysize);
+    if ((xsize > IFT_RADON_Q16_MAX_SIDE) || (ysize > IFT_RADON_Q16_MAX_SIDE))
+        iftError("Image size (%d, %d) too large for the fixed-point rays (at most %d)", "iftCreateRadonEM", xsize,
+                 ysize, IFT_RADON_Q16_MAX_SIDE);
+    if ((nsubsets < 1) || (nsubsets > IFT_RADON_NANGLES))
+        iftError("Invalid number of subsets: %d (1 to %d)", "iftCreateRadonEM", nsubsets, IFT_RADON_NANGLES);
+
+    iftRadonEM *em = (iftRadonEM *) iftAlloc(1, sizeof(iftRadonEM));
+    long n = (long) xsize * ysize;
+    em->xsize    = xsize;
+    em->ysize    = ysize;
+    em->nbins    = (int) sqrt(xsize*xsize + ysize*ysize);
+    em->nsubsets = nsubsets;
+    em->nthreads = omp_get_max_threads();
+
+    em->tby = iftAllocIntArray(ysize);
+    for (int y = 0; y < ysize; y++)
+        em->tby[y] = y * xsize;
+
+    em->rays = (iftRadonRay *) iftAlloc((size_t) IFT_RADON_NANGLES * em->nbins, sizeof(iftRadonRay));
+    #pragma omp parallel num_threads(em->nthreads)
+    {
+        iftArena *arena = iftCreateArena(0);
+
+        #pragma omp for
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            double tic = iftRadonStatsTic();
+            iftResetArena(arena);
+            iftRadonComputeRays(xsize, ysize, theta, 0, em->nbins, &em->rays[theta * em->nbins], arena);
+            iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+        }
+
+        iftRadonDestroyArena(&arena);
+    }
+
+    em->bp       = iftAllocFloatArray(n);
+    em->ratio    = iftAllocFloatArray((size_t) iftRadonEMSubsetAngles(em, 0) * em->nbins);
+    em->inv_sens = iftAllocFloatArray(nsubsets * n);
+    iftRadonEMComputeSensitivity(em);
+
+    return em;
+}
+
+
+void iftDestroyRadonEM(iftRadonEM **em)
+{
+    if (em == NULL || *em == NULL)
+        return;
+
+    iftFree((*em)->tby);
+    iftFree((*em)->rays);
+    iftFree((*em)->inv_sens);
+    iftFree((*em)->bp);
+    iftFree((*em)->ratio);
+    iftFree(*em);
+    *em = NULL;
+}
+
+
+int iftRadonEMNumberOfSubsets(const iftRadonEM *em)
+{
+    return em->nsubsets;
+}
+
+
+/* checks that R is a sinogram of counts of the image size of the geometry */
+static void iftRadonEMCheckSinogram(const iftRadonEM *em, const iftImage *R, const char *function)
+{
+    if ((R->xsize != IFT_RADON_NANGLES) || (R->ysize != em->nbins))
+        iftError("Sinogram size (%d, %d) does not match the geometry: expected (%d, %d)", function, R->xsize,
+                 R->ysize, IFT_RADON_NANGLES, em->nbins);
+    for (int p = 0; p < R->n; p++)
+        if (R->val[p] < 0)
+            iftError("Negative count %d at (%d, %d)", function, R->val[p], p % R->xsize, p / R->xsize);
+}
+
+
+/*
+ * One update of the subset s: the threads project the rays of x and keep the ratios of the measured to the
+ * projected counts, then each thread back-projects all the ratios into its own band of rows and corrects the
+ * pixels of its band. The bands are disjoint, so no buffer is shared or reduced.
+ */
+static void iftRadonEMUpdate(iftRadonEM *em, const iftImage *R, float *x, int s)
+{
+    long n = (long) em->xsize * em->ysize;
+    long nrays = (long) iftRadonEMSubsetAngles(em, s) * em->nbins;
+    const float *inv_sens = &em->inv_sens[s * n];
+
+    #pragma omp parallel num_threads(em->nthreads)
+    {
+        #pragma omp for schedule(dynamic, IFT_RADON_EM_CHUNK)
+        for (long i = 0; i < nrays; i++) {
+            long bin;
+            const iftRadonRay *ray = iftRadonEMSubsetRay(em, s, i, &bin);
+            float J = (ray->valid && (R->val[bin] > 0)) ? iftRadonEMProjectRay(x, em->tby, ray) : 0;
+            em->ratio[i] = (J > 0) ? R->val[bin] / J : 0;
+        }
+
+        int y0, y1;
+        iftRadonEMBand(em, omp_get_thread_num(), omp_get_num_threads(), &y0, &y1);
+
+        for (long i = 0; i < nrays; i++)
+            if (em->ratio[i] > 0) {
+                long bin;
+                const iftRadonRay *ray = iftRadonEMSubsetRay(em, s, i, &bin);
+                iftRadonEMBackProjectRay(em->bp, em->tby, ray, em->ratio[i], y0, y1);
+            }
+
+        for (long p = (long) y0 * em->xsize; p < (long) y1 * em->xsize; p++) {
+            if (inv_sens[p] > 0)
+                x[p] *= em->bp[p] * inv_sens[p];
+            em->bp[p] = 0;
+        }
+    }
+}
+
+
+void iftRadonEMIterate(iftRadonEM *em, const iftImage *R, iftFImage *x, int niters)
+{
+    iftRadonEMCheckSinogram(em, R, "iftRadonEMIterate");
+    if ((x->xsize != em->xsize) || (x->ysize != em->ysize))
+        iftError("Image size (%d, %d) does not match the geometry: expected (%d, %d)", "iftRadonEMIterate",
+                 x->xsize, x->ysize, em->xsize, em->ysize);
+
+    for (int it = 0; it < niters; it++)
+        for (int s = 0; s < em->nsubsets; s++) {
+            double tic = omp_get_wtime();
+            iftRadonEMUpdate(em, R, x->val, s);
+            double toc = omp_get_wtime();
+
+            em->update_time += toc - tic;
+            em->nupdates++;
+            if (ift_radon_stats_verbosity > 0)
+                iftRadonStatsToc(IFT_RADON_STAGE_EM_UPDATE, tic);
+        }
+}
+
+
+iftFImage *iftRadonEMReconstruction(iftRadonEM *em, const iftImage *R, int niters)
+{
+    iftRadonEMCheckSinogram(em, R, "iftRadonEMReconstruction");
+
+    /* uniform image whose projections have the counts of the sinogram, except where no ray passes */
+    long n = (long) em->xsize * em->ysize;
+    double counts = 0;
+    for (int p = 0; p < R->n; p++)
+        counts += R->val[p];
+    float x0 = (em->nsamples > 0) ? counts / em->nsamples : 0;
+
+    iftFImage *x = iftCreateFImage(em->xsize, em->ysize, 1);
+    for (long p = 0; p < n; p++)
+        for (int s = 0; s < em->nsubsets; s++)
+            if (em->inv_sens[s * n + p] > 0) {
+                x->val[p] = x0;
+                break;
+            }
+
+    iftRadonEMIterate(em, R, x, niters);
+
+    return x;
+}
+
+
+iftFImage *iftRadonEMForwardProjection(const iftRadonEM *em, const iftFImage *x)
+{
+    if ((x->xsize != em->xsize) || (x->ysize != em->ysize))
+        iftError("Image size (%d, %d) does not match the geometry: expected (%d, %d)",
+                 "iftRadonEMForwardProjection", x->xsize, x->ysize, em->xsize, em->ysize);
+
+    iftFImage *y = iftCreateFImage(IFT_RADON_NANGLES, em->nbins, 1);
+    long nrays = (long) IFT_RADON_NANGLES * em->nbins;
+
+    #pragma omp parallel for num_threads(em->nthreads) schedule(dynamic, IFT_RADON_EM_CHUNK)
+    for (long i = 0; i < nrays; i++) {
+        const iftRadonRay *ray = &em->rays[i];
+        int theta = (int) (i / em->nbins), rho = (int) (i % em->nbins);
+        y->val[(long) rho * IFT_RADON_NANGLES + theta] = ray->valid ? iftRadonEMProjectRay(x->val, em->tby, ray) : 0;
+    }
+
+    return y;
+}
+
+
+iftFImage *iftRadonEMBackProjection(const iftRadonEM *em, const iftFImage *y)
+{
+    if ((y->xsize != IFT_RADON_NANGLES) || (y->ysize != em->nbins))
+        iftError("Sinogram size (%d, %d) does not match the geometry: expected (%d, %d)",
+                 "iftRadonEMBackProjection", y->xsize, y->ysize, IFT_RADON_NANGLES, em->nbins);
+
+    iftFImage *x = iftCreateFImage(em->xsize, em->ysize, 1);
+    long nrays = (long) IFT_RADON_NANGLES * em->nbins;
+
+    #pragma omp parallel num_threads(em->nthreads)
+    {
+        int y0, y1;
+        iftRadonEMBand(em, omp_get_thread_num(), omp_get_num_threads(), &y0, &y1);
+
+        for (long i = 0; i < nrays; i++) {
+            const iftRadonRay *ray = &em->rays[i];
+            int theta = (int) (i / em->nbins), rho = (int) (i % em->nbins);
+            float v = y->val[(long) rho * IFT_RADON_NANGLES + theta];
+            if (ray->valid && (v != 0))
+                iftRadonEMBackProjectRay(x->val, em->tby, ray, v, y0, y1);
+        }
+    }
+
+    return x;
+}
+
+
+double iftRadonEMMeanUpdateTime(const iftRadonEM *em)
+{
+    return (em->nupdates > 0) ? 1000 * em->update_time / em->nupdates : 0;
+}
@@ -0,0 +1,402 @@
+#include "iftRadonFFT.h"
+
+/* maximum number of stages (prime factors, at least 2 each) */
+#define IFT_RADON_FFT_MAX_STAGES 32
+
+
+/* one Stockham pass of radix p over sequences of the current length L = p * m */
+typedef struct {
+    int p, m;
+    /* twiddles W_L^(j t) for j < m and 1 <= t < p: tw[j * (p - 1) + t - 1], W_L = exp(2 pi i / L), conjugated
+       by the forward transforms */
+    double *tw_re, *tw_im;
+    /* roots of the radix: exp(2 pi i r / p), for the generic butterfly */
+    double *root_re, *root_im;
+} iftRadonFFTStage;
+
+
+struct ift_radon_fft {
+    int n;
+    int nstages;
+    iftRadonFFTStage stage[IFT_RADON_FFT_MAX_STAGES];
+    /* even n: plan of n / 2 and the twiddles exp(-2 pi i k / n), k <= n / 4, of the real transforms */
+    iftRadonFFT *half;
+    double *real_re, *real_im;
+};
+
+
+iftRadonFFT *iftCreateRadonFFT(int n)
+{
+    if (n < 1)
+        iftError("Invalid FFT length: %d", "iftCreateRadonFFT", n);
+
+    iftRadonFFT *fft = (iftRadonFFT *) iftAlloc(1, sizeof(iftRadonFFT));
+    fft->n = n;
+
+    /* radix 4 first (the cheapest butterfly per element), then the primes */
+    int L = n;
+    while (L > 1) {
+        int p = (L % 4 == 0) ? 4 : 2;
+        while (L % p != 0)
+            p = (p == 2) ? 3 : p + 2;
+
+        iftRadonFFTStage *stage = &fft->stage[fft->nstages++];
+        stage->p     = p;
+        stage->m     = L / p;
+        stage->tw_re = iftAllocDoubleArray((size_t) stage->m * (p - 1));
+        stage->tw_im = iftAllocDoubleArray((size_t) stage->m * (p - 1));
+        for (int j = 0; j < stage->m; j++)
+            for (int t = 1; t < p; t++) {
+                double a = 2.0 * IFT_PI * ((long) j * t % L) / L;
+                stage->tw_re[j * (p - 1) + t - 1] = cos(a);
+                stage->tw_im[j * (p - 1) + t - 1] = sin(a);
+            }
+        stage->root_re = iftAllocDoubleArray(p);
+        stage->root_im = iftAllocDoubleArray(p);
+        for (int r = 0; r < p; r++) {
+            stage->root_re[r] = cos(2.0 * IFT_PI * r / p);
+            stage->root_im[r] = sin(2.0 * IFT_PI * r / p);
+        }
+        L = stage->m;
+    }
+
+    if ((n % 2 == 0) && (n > 2)) {
+        fft->half    = iftCreateRadonFFT(n / 2);
+        fft->real_re = iftAllocDoubleArray(n / 4 + 1);
+        fft->real_im = iftAllocDoubleArray(n / 4 + 1);
+        for (int k = 0; k <= n / 4; k++) {
+            fft->real_re[k] = cos(-2.0 * IFT_PI * k / n);
+            fft->real_im[k] = sin(-2.0 * IFT_PI * k / n);
+        }
+    }
+
+    return fft;
+}
+
+
+void iftDestroyRadonFFT(iftRadonFFT **fft)
+{
+    if (fft == NULL || *fft == NULL)
+        return;
+
+    for (int s = 0; s < (*fft)->nstages; s++) {
+        iftFree((*fft)->stage[s].tw_re);
+        iftFree((*fft)->stage[s].tw_im);
+        iftFree((*fft)->stage[s].root_re);
+        iftFree((*fft)->stage[s].root_im);
+    }
+    if ((*fft)->half != NULL) {
+        iftDestroyRadonFFT(&(*fft)->half);
+        iftFree((*fft)->real_re);
+        iftFree((*fft)->real_im);
+    }
+    iftFree(*fft);
+    *fft = NULL;
+}
+
+
+int iftRadonFFTLength(const iftRadonFFT *fft)
+{
+    return fft->n;
+}
+
+
+int iftRadonFFTGoodSize(int n)
+{
+    for (int size = iftMax(n, 1); ; size++) {
+        int m = size;
+        while (m % 2 == 0) m /= 2;
+        while (m % 3 == 0) m /= 3;
+        while (m % 5 == 0) m /= 5;
+        if (m == 1)
+            return size;
+    }
+}
+
+
+/*
+ * One pass of the decimation-in-frequency Stockham FFT: for each j < m, the p elements x[j + r m] of every
+ * sequence go through a DFT of size p, and output t, times W_L^(j t), goes to y[p j + t]. Indices are in
+ * units of s contiguous values (the interleaved sequences and the strides of the previous passes), which the
+ * innermost loops run over.
+ */
+static void iftRadonFFTPass(const iftRadonFFTStage *stage, int s, int sign,
+                            const double *restrict xr, const double *restrict xi,
+                            double *restrict yr, double *restrict yi)
+{
+    int p = stage->p, m = stage->m;
+    long ms = (long) m * s;
+
+    for (int j = 0; j < m; j++) {
+        const double *twr = &stage->tw_re[j * (p - 1)], *twi = &stage->tw_im[j * (p - 1)];
+        const double *ar = &xr[(long) j * s], *ai = &xi[(long) j * s];
+        double *br = &yr[(long) p * j * s], *bi = &yi[(long) p * j * s];
+
+        if (p == 2) {
+            double w1r = twr[0], w1i = sign * twi[0];
+            for (int q = 0; q < s; q++) {
+                double a0r = ar[q], a0i = ai[q], a1r = ar[q + ms], a1i = ai[q + ms];
+                double dr = a0r - a1r, di = a0i - a1i;
+                br[q]     = a0r + a1r;
+                bi[q]     = a0i + a1i;
+                br[q + s] = dr * w1r - di * w1i;
+                bi[q + s] = dr * w1i + di * w1r;
+            }
+        } else if (p == 4) {
+            double w1r = twr[0], w1i = sign * twi[0], w2r = twr[1], w2i = sign * twi[1];
+            double w3r = twr[2], w3i = sign * twi[2];
+            for (int q = 0; q < s; q++) {
+                double a0r = ar[q], a0i = ai[q], a1r = ar[q + ms], a1i = ai[q + ms];
+                double a2r = ar[q + 2 * ms], a2i = ai[q + 2 * ms], a3r = ar[q + 3 * ms], a3i = ai[q + 3 * ms];
+                double s02r = a0r + a2r, s02i = a0i + a2i, d02r = a0r - a2r, d02i = a0i - a2i;
+                double s13r = a1r + a3r, s13i = a1i + a3i;
+                /* (a1 - a3) times exp(sign pi i / 2) = sign i */
+                double d13r = -sign * (a1i - a3i), d13i = sign * (a1r - a3r);
+                double b1r = d02r + d13r, b1i = d02i + d13i;
+                double b2r = s02r - s13r, b2i = s02i - s13i;
+                double b3r = d02r - d13r, b3i = d02i - d13i;
+                br[q]         = s02r + s13r;
+                bi[q]         = s02i + s13i;
+                br[q + s]     = b1r * w1r - b1i * w1i;
+                bi[q + s]     = b1r * w1i + b1i * w1r;
+                br[q + 2 * s] = b2r * w2r - b2i * w2i;
+                bi[q + 2 * s] = b2r * w2i + b2i * w2r;
+                br[q + 3 * s] = b3r * w3r - b3i * w3i;
+                bi[q + 3 * s] = b3r * w3i + b3i * w3r;
+            }
+        } else if (p == 3) {
+            double w1r = twr[0], w1i = sign * twi[0], w2r = twr[1], w2i = sign * twi[1];
+            double c = sign * 0.86602540378443864676; /* sign * sin(pi / 3) */
+            for (int q = 0; q < s; q++) {
+                double a0r = ar[q], a0i = ai[q], a1r = ar[q + ms], a1i = ai[q + ms];
+                double a2r = ar[q + 2 * ms], a2i = ai[q + 2 * ms];
+                double tr = a1r + a2r, ti = a1i + a2i;
+                double mr = a0r - 0.5 * tr, mi = a0i - 0.5 * ti;
+                /* i c (a1 - a2) */
+                double nr = -c * (a1i - a2i), ni = c * (a1r - a2r);
+                double b1r = mr + nr, b1i = mi + ni, b2r = mr - nr, b2i = mi - ni;
+                br[q]         = a0r + tr;
+                bi[q]         = a0i + ti;
+                br[q + s]     = b1r * w1r - b1i * w1i;
+                bi[q + s]     = b1r * w1i + b1i * w1r;
+                br[q + 2 * s] = b2r * w2r - b2i * w2i;
+                bi[q + 2 * s] = b2r * w2i + b2i * w2r;
+            }
+        } else {
+            /* any prime radix: O(p^2) butterfly */
+            for (int t = 0; t < p; t++) {
+                double wr = (t == 0) ? 1 : twr[t - 1], wi = (t == 0) ? 0 : sign * twi[t - 1];
+                for (int q = 0; q < s; q++) {
+                    double sr = 0, si = 0;
+                    for (int r = 0; r < p; r++) {
+                        double rr = stage->root_re[(r * t) % p], ri = sign * stage->root_im[(r * t) % p];
+                        double xr_ = ar[q + r * ms], xi_ = ai[q + r * ms];
+                        sr += xr_ * rr - xi_ * ri;
+                        si += xr_ * ri + xi_ * rr;
+                    }
+                    br[q + t * s] = sr * wr - si * wi;
+                    bi[q + t * s] = sr * wi + si * wr;
+                }
+            }
+        }
+    }
+}
+
+
+void iftExecuteRadonFFT(const iftRadonFFT *fft, double *re, double *im, int howmany, int sign)
+{
+    if ((sign != IFT_RADON_FFT_FORWARD) && (sign != IFT_RADON_FFT_INVERSE))
+        iftError("Invalid FFT sign: %d", "iftExecuteRadonFFT", sign);
+    if (fft->nstages == 0)
+        return;
+
+    size_t size = (size_t) fft->n * howmany;
+    double *wr = iftAllocDoubleArray(size), *wi = iftAllocDoubleArray(size);
+
+    /* ping-pong between the data and the work buffers */
+    double *xr = re, *xi = im, *yr = wr, *yi = wi;
+    int s = howmany;
+    for (int st = 0; st < fft->nstages; st++) {
+        iftRadonFFTPass(&fft->stage[st], s, sign, xr, xi, yr, yi);
+        s *= fft->stage[st].p;
+        double *tr = xr, *ti = xi;
+        xr = yr; xi = yi;
+        yr = tr; yi = ti;
+    }
+    if (xr != re) {
+        memcpy(re, xr, size * sizeof(double));
+        memcpy(im, xi, size * sizeof(double));
+    }
+
+    iftFree(wr);
+    iftFree(wi);
+}
+
+
+void iftExecuteRadonRealFFT(const iftRadonFFT *fft, const double *in, double *re, double *im, int howmany)
+{
+    int n = fft->n;
+
+    /* odd (or tiny) lengths: complex transform of the real sequences */
+    if (fft->half == NULL) {
+        size_t size = (size_t) n * howmany;
+        double *zr = iftAllocDoubleArray(size), *zi = iftAllocDoubleArray(size);
+        memcpy(zr, in, size * sizeof(double));
+        iftExecuteRadonFFT(fft, zr, zi, howmany, IFT_RADON_FFT_FORWARD);
+        memcpy(re, zr, (size_t) (n / 2 + 1) * howmany * sizeof(double));
+        memcpy(im, zi, (size_t) (n / 2 + 1) * howmany * sizeof(double));
+        iftFree(zr);
+        iftFree(zi);
+        return;
+    }
+
+    /* z[k] = x[2k] + i x[2k + 1], a complex sequence of half the length */
+    int h = n / 2;
+    size_t size = (size_t) h * howmany;
+    double *zr = iftAllocDoubleArray(size), *zi = iftAllocDoubleArray(size);
+    for (int k = 0; k < h; k++)
+        for (int b = 0; b < howmany; b++) {
+            zr[(size_t) k * howmany + b] = in[(size_t) 2 * k * howmany + b];
+            zi[(size_t) k * howmany + b] = in[(size_t) (2 * k + 1) * howmany + b];
+        }
+    iftExecuteRadonFFT(fft->half, zr, zi, howmany, IFT_RADON_FFT_FORWARD);
+
+    /*
+     * The DFTs of the even and odd samples are E[k] = (Z[k] + conj(Z[h - k])) / 2 and
+     * O[k] = (Z[k] - conj(Z[h - k])) / 2i, and X[k] = E[k] + W^k O[k], X[h - k] = conj(E[k] - W^k O[k]),
+     * with W = exp(-2 pi i / n): both come from the same pair of Z.
+     */
+    for (int k = 0; k <= h / 2; k++) {
+        int kk = (h - k) % h;
+        double wr = fft->real_re[k], wi = fft->real_im[k];
+        for (int b = 0; b < howmany; b++) {
+            double z1r = zr[(size_t) k * howmany + b], z1i = zi[(size_t) k * howmany + b];
+            double z2r = zr[(size_t) kk * howmany + b], z2i = zi[(size_t) kk * howmany + b];
+            double er = 0.5 * (z1r + z2r), ei = 0.5 * (z1i - z2i);
+            double o_r = 0.5 * (z1i + z2i), o_i = -0.5 * (z1r - z2r);
+            double tr = wr * o_r - wi * o_i, ti = wr * o_i + wi * o_r;
+            re[(size_t) k * howmany + b]       = er + tr;
+            im[(size_t) k * howmany + b]       = ei + ti;
+            re[(size_t) (h - k) * howmany + b] = er - tr;
+            im[(size_t) (h - k) * howmany + b] = -(ei - ti);
+        }
+    }
+
+    iftFree(zr);
+    iftFree(zi);
+}
+
+
+void iftExecuteRadonInverseRealFFT(const iftRadonFFT *fft, const double *re, const double *im, double *out,
+                                   int howmany)
+{
+    int n = fft->n;
+
+    /* odd (or tiny) lengths: complex transform of the full Hermitian spectrum */
+    if (fft->half == NULL) {
+        size_t size = (size_t) n * howmany;
+        double *zr = iftAllocDoubleArray(size), *zi = iftAllocDoubleArray(size);
+        for (int k = 0; k < n; k++)
+            for (int b = 0; b < howmany; b++) {
+                int kk = (k <= n / 2) ? k : n - k;
+                zr[(size_t) k * howmany + b] = re[(size_t) kk * howmany + b];
+                zi[(size_t) k * howmany + b] = (k <= n / 2) ? im[(size_t) kk * howmany + b] :
+                                                             -im[(size_t) kk * howmany + b];
+            }
+        iftExecuteRadonFFT(fft, zr, zi, howmany, IFT_RADON_FFT_INVERSE);
+        memcpy(out, zr, size * sizeof(double));
+        iftFree(zr);
+        iftFree(zi);
+        return;
+    }
+
+    /* Z[k] = 2 E[k] + 2i O[k] from the pairs X[k], X[h - k] (inverse of iftExecuteRadonRealFFT()) */
+    int h = n / 2;
+    size_t size = (size_t) h * howmany;
+    double *zr = iftAllocDoubleArray(size), *zi = iftAllocDoubleArray(size);
+    for (int k = 0; k <= h / 2; k++) {
+        int kk = h - k;
+        double wr = fft->real_re[k], wi = -fft->real_im[k];
+        for (int b = 0; b < howmany; b++) {
+            double x1r = re[(size_t) k * howmany + b], x1i = im[(size_t) k * howmany + b];
+            double x2r = re[(size_t) kk * howmany + b], x2i = im[(size_t) kk * howmany + b];
+            /* 2E[k] = X[k] + conj(X[h - k]), 2O[k] = (X[k] - conj(X[h - k])) W^-k */
+            double er = x1r + x2r, ei = x1i - x2i;
+            double dr = x1r - x2r, di = x1i + x2i;
+            double o_r = dr * wr - di * wi, o_i = dr * wi + di * wr;
+            zr[(size_t) k * howmany + b] = er - o_i;
+            zi[(size_t) k * howmany + b] = ei + o_r;
+            if ((kk < h) && (kk != k)) {
+                /* 2E[h - k] = conj(2E[k]) and 2O[h - k] = conj(2O[k]) */
+                zr[(size_t) kk * howmany + b] = er + o_i;
+                zi[(size_t) kk * howmany + b] = -ei + o_r;
+            }
+        }
+    }
+    iftExecuteRadonFFT(fft->half, zr, zi, howmany, IFT_RADON_FFT_INVERSE);
+
+    for (int k = 0; k < h; k++)
+        for (int b = 0; b < howmany; b++) {
+            out[(size_t) 2 * k * howmany + b]       = zr[(size_t) k * howmany + b];
+            out[(size_t) (2 * k + 1) * howmany + b] = zi[(size_t) k * howmany + b];
+        }
+
+    iftFree(zr);
+    iftFree(zi);
+}
+
+
+void iftRadonRampResponse(const iftRadonFFT *fft, double *H)
+{
+    int L = fft->n;
+
+    /* the filter, circularly centered at 0: its response is real, since it is even */
+    double *h = iftAllocDoubleArray(L), *Hi = iftAllocDoubleArray(L / 2 + 1);
+    h[0] = 0.25;
+    for (int k = 1; k < L / 2 + 1; k += 2) {
+        h[k] = -1.0 / (IFT_PI * IFT_PI * k * k);
+        h[L - k] = h[k];
+    }
+    iftExecuteRadonRealFFT(fft, h, H, Hi, 1);
+
+    iftFree(h);
+    iftFree(Hi);
+}
+
+
+iftFImage *iftRadonRampFilter(const iftImage *R)
+{
+    if (R->xsize != IFT_RADON_NANGLES)
+        iftError("Invalid sinogram: %d columns (expected %d)", "iftRadonRampFilter", R->xsize, IFT_RADON_NANGLES);
+
+    int nbins = R->ysize, L = iftRadonFFTGoodSize(2 * nbins);
+    iftRadonFFT *fft = iftCreateRadonFFT(L);
+    double *Hr = iftAllocDoubleArray(L / 2 + 1);
+    iftRadonRampResponse(fft, Hr);
+
+    /* the sinogram rows are the interleaved columns: element rho of the column theta at rho * NANGLES + theta */
+    double *p = iftAllocDoubleArray((size_t) L * IFT_RADON_NANGLES);
+    double *Pr = iftAllocDoubleArray((size_t) (L / 2 + 1) * IFT_RADON_NANGLES);
+    double *Pi = iftAllocDoubleArray((size_t) (L / 2 + 1) * IFT_RADON_NANGLES);
+    for (int i = 0; i < R->n; i++)
+        p[i] = R->val[i];
+    iftExecuteRadonRealFFT(fft, p, Pr, Pi, IFT_RADON_NANGLES);
+    for (int k = 0; k <= L / 2; k++)
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            Pr[(size_t) k * IFT_RADON_NANGLES + theta] *= Hr[k] / L;
+            Pi[(size_t) k * IFT_RADON_NANGLES + theta] *= Hr[k] / L;
+        }
+    iftExecuteRadonInverseRealFFT(fft, Pr, Pi, p, IFT_RADON_NANGLES);
+
+    iftFImage *Q = iftCreateFImage(IFT_RADON_NANGLES, nbins, 1);
+    for (int i = 0; i < Q->n; i++)
+        Q->val[i] = p[i];
+
+    iftFree(Hr);
+    iftFree(p);
+    iftFree(Pr);
+    iftFree(Pi);
+    iftDestroyRadonFFT(&fft);
+
+    return Q;
+}
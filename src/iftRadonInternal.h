@@ -0,0 +1,208 @@
+/*
+ * Internal declarations shared by the Radon projectors (not part of the public headers): the clipped
+ * rays and the typed ray-sum kernels.
+ */
+
+#ifndef IFT_RADON_INTERNAL_H
+#define IFT_RADON_INTERNAL_H
+
+#include <stdint.h>
+#include "iftRadon.h"
+#include "iftArena.h"
+#include "iftRadonStats.h"
+
+#define IFT_RADON_Q16_SHIFT 16
+#define IFT_RADON_Q16_ONE   (1 << IFT_RADON_Q16_SHIFT)
+/* largest image side whose pixel coordinates fit into the int32 Q16.16 ray positions */
+#define IFT_RADON_Q16_MAX_SIDE 32767
+
+/* number of interleaved images traced together by the batch kernels (padded with zeros) */
+#define IFT_RADON_BATCH 16
+
+/**
+ * @brief Clipped ray of a detector bin: the DDA goes from p1 to pn.
+ */
+typedef struct ift_radon_ray {
+    iftVoxel p1, pn;
+    /** 0 when the ray misses the image */
+    int valid;
+} iftRadonRay;
+
+
+static inline int iftRadonSign(int x)
+{
+    if (x >= 0)
+        return 1;
+    return -1;
+}
+
+
+/* iftAlloc() counted in IFT_RADON_COUNTER_ALLOCS: the heap buffers of the projectors outside their arenas */
+static inline void *iftRadonAlloc(size_t n, size_t size)
+{
+    iftRadonStatsCount(IFT_RADON_COUNTER_ALLOCS, 1);
+    return iftAlloc(n, size);
+}
+
+
+/* whether the images of a size are traced with Q16.16 stepping; otherwise the reference kernel (i32f) traces them */
+static inline bool iftRadonFixedStepFits(int xsize, int ysize)
+{
+#ifdef IFT_RADON_REFERENCE_KERNEL
+    (void) xsize;
+    (void) ysize;
+    return false;
+#else
+    return (xsize <= IFT_RADON_Q16_MAX_SIDE) && (ysize <= IFT_RADON_Q16_MAX_SIDE);
+#endif
+}
+
+
+/* kernel of pixels whose values OR-ed together (as unsigned) give bits, see iftRadonNarrowestPixelType() */
+static inline iftRadonPixelType iftRadonPixelTypeOfBits(uint32_t bits, int xsize, int ysize)
+{
+    if (!iftRadonFixedStepFits(xsize, ysize) || (bits > USHRT_MAX))
+        return IFT_RADON_INT32;
+    return (bits <= UCHAR_MAX) ? IFT_RADON_UINT8 : IFT_RADON_UINT16;
+}
+
+
+/* OR of n pixels as unsigned (negative values set the high bits), stopping once they exceed 16 bits */
+static inline uint32_t iftRadonPixelBits(const int *val, size_t n)
+{
+    uint32_t bits = 0;
+
+    for (size_t p = 0; (p < n) && (bits <= USHRT_MAX); ) {
+        size_t end = iftMin(n, p + 4096);
+        for (; p < end; p++)
+            bits |= (uint32_t) val[p];
+    }
+
+    return bits;
+}
+
+
+/* kernel of the n pixels of an xsize x ysize image: one pass, see iftRadonNarrowestPixelType() */
+static inline iftRadonPixelType iftRadonPixelTypeOf(const int *val, size_t n, int xsize, int ysize)
+{
+    if (!iftRadonFixedStepFits(xsize, ysize))
+        return IFT_RADON_INT32;
+    return iftRadonPixelTypeOfBits(iftRadonPixelBits(val, n), xsize, ysize);
+}
+
+
+/* destroys a scratch arena, adding its heap allocations to IFT_RADON_COUNTER_ALLOCS */
+static inline void iftRadonDestroyArena(iftArena **arena)
+{
+    iftRadonStatsCount(IFT_RADON_COUNTER_ALLOCS, (long) (*arena)->nheap_allocs);
+    iftDestroyArena(arena);
+}
+
+
+/* kernels for each pixel type, generated from the same source */
+#define IFT_RADON_SUFFIX     u8
+#define IFT_RADON_IN_T       uchar
+#define IFT_RADON_ACC_T      int32_t
+#define IFT_RADON_FIXED_STEP 1
+#include "iftRadonKernel.inc"
+
+#define IFT_RADON_SUFFIX     u16
+#define IFT_RADON_IN_T       ushort
+#define IFT_RADON_ACC_T      int32_t
+#define IFT_RADON_FIXED_STEP 1
+#include "iftRadonKernel.inc"
+
+#define IFT_RADON_SUFFIX     i32
+#define IFT_RADON_IN_T       int
+#define IFT_RADON_ACC_T      int64_t
+#define IFT_RADON_FIXED_STEP 1
+#include "iftRadonKernel.inc"
+
+/* the reference kernel, also used by the images too large for the fixed-point positions */
+#define IFT_RADON_SUFFIX     i32f
+#define IFT_RADON_IN_T       int
+#define IFT_RADON_ACC_T      float
+#define IFT_RADON_FIXED_STEP 0
+#include "iftRadonKernel.inc"
+
+/* the kernel is selected by the pointer type of the pixel buffer (fixed-point stepping, see iftRadonFixedStepFits()) */
+#define iftRadonProjectRays(val, tby, rays, nrays, out, stride) \
+    _Generic((val),                                             \
+        uchar *:  iftRadonProjectRays_u8,                       \
+        ushort *: iftRadonProjectRays_u16,                      \
+        int *:    iftRadonProjectRays_i32)((val), (tby), (rays), (nrays), (out), (stride))
+
+#define iftRadonProjectRaysBatch(val, nimgs, tby, rays, nrays, out, offset, stride)                  \
+    _Generic((val),                                                                                \
+        uchar *:  iftRadonProjectRaysBatch_u8,                                                     \
+        ushort *: iftRadonProjectRaysBatch_u16,                                                    \
+        int *:    iftRadonProjectRaysBatch_i32)((val), (nimgs), (tby), (rays), (nrays), (out), (offset), (stride))
+
+
+/* counts the traced rays and the pixels read by their ray sums (only when the statistics are enabled) */
+static inline void iftRadonCountRays(const iftRadonRay *rays, int nrays)
+{
+    if (ift_radon_stats_verbosity == 0)
+        return;
+
+    long nvalid = 0, nsamples = 0;
+    for (int i = 0; i < nrays; i++)
+        if (rays[i].valid) {
+            nvalid++;
+            nsamples += iftMax(1, iftMax(abs(rays[i].pn.x - rays[i].p1.x), abs(rays[i].pn.y - rays[i].p1.y)));
+        }
+    iftRadonStatsCount(IFT_RADON_COUNTER_RAYS, nvalid);
+    iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, nsamples);
+}
+
+
+/* clips the rays of the detector bins first..first+nrays-1 of the angle theta against a xsize x ysize image */
+void iftRadonComputeRays(int xsize, int ysize, int theta, int first, int nrays, iftRadonRay *rays, iftArena *arena);
+
+
+/*
+ * The rays of the angles below 45 and above 135 run along y, i.e., down the image columns. They are traced
+ * on the transposed image instead, along its rows: the DDA is symmetric in x and y, so the sums are the same.
+ */
+static inline bool iftRadonIsColumnAngle(int theta)
+{
+    return (theta < 45) || (theta > 135);
+}
+
+
+/* rays of the transposed image */
+static inline void iftRadonTransposeRays(const iftRadonRay *rays, int nrays, iftRadonRay *out)
+{
+    for (int i = 0; i < nrays; i++) {
+        out[i].valid = rays[i].valid;
+        out[i].p1 = (iftVoxel) {.x = rays[i].p1.y, .y = rays[i].p1.x, .z = 0};
+        out[i].pn = (iftVoxel) {.x = rays[i].pn.y, .y = rays[i].pn.x, .z = 0};
+    }
+}
+
+
+/* transposes a xsize x ysize buffer: out[x * ysize + y] = in[y * xsize + x] */
+#define iftRadonTranspose(out, in, xsize, ysize)                                        \
+    do {                                                                                \
+        for (int y_ = 0; y_ < (ysize); y_++)                                            \
+            for (int x_ = 0; x_ < (xsize); x_++)                                        \
+                (out)[(size_t) x_ * (ysize) + y_] = (in)[(size_t) y_ * (xsize) + x_];   \
+    } while (0)
+
+
+/* NUMA nodes are numbered 0..iftRadonNumaNumberOfNodes()-1 (src/iftRadonNuma.c) */
+#define IFT_RADON_NUMA_MAX_NODES 64
+
+/* number of NUMA nodes with CPUs (1 when the topology is unknown) */
+int iftRadonNumaNumberOfNodes(void);
+
+/* restricts the calling thread to the CPUs of a node; returns false if it failed */
+bool iftRadonNumaPinThread(int node);
+
+/* node of the CPU running the calling thread */
+int iftRadonNumaCurrentNode(void);
+
+/* node of the memory page holding ptr, or -1 if unknown (e.g., a page not touched yet) */
+int iftRadonNumaNodeOfAddress(const void *ptr);
+
+#endif //IFT_RADON_INTERNAL_H
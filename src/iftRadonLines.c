@@ -0,0 +1,121 @@
+#include "iftRadonLines.h"
+#include "iftRadonInternal.h"
+#include "iftDHeap.h"
+
+
+/* sinogram value at (theta, rho), where theta may leave [0, 180) and wraps with rho mirrored */
+static inline int iftRadonWrappedVal(const iftImage *R, int theta, int rho, bool *valid)
+{
+    if (theta < 0) {
+        theta += IFT_RADON_NANGLES;
+        rho = R->ysize - 1 - rho;
+    } else if (theta >= IFT_RADON_NANGLES) {
+        theta -= IFT_RADON_NANGLES;
+        rho = R->ysize - 1 - rho;
+    }
+    *valid = (rho >= 0) && (rho < R->ysize);
+
+    return (*valid) ? iftImgVal2D(R, theta, rho) : 0;
+}
+
+
+static bool iftRadonIsPeak(const iftImage *R, int theta, int rho, int radius)
+{
+    int val = iftImgVal2D(R, theta, rho);
+    bool valid;
+
+    for (int dr = -radius; dr <= radius; dr++)
+        for (int dt = -radius; dt <= radius; dt++) {
+            if (dt == 0 && dr == 0)
+                continue;
+            int neighbor = iftRadonWrappedVal(R, theta + dt, rho + dr, &valid);
+            if (!valid)
+                continue;
+            /* ties go to the first bin in raster order (rho, then theta) */
+            bool before = (dr < 0) || (dr == 0 && dt < 0);
+            if ((neighbor > val) || (before && neighbor == val))
+                return false;
+        }
+
+    return true;
+}
+
+
+void iftDestroyRadonLineArray(iftRadonLineArray **lines)
+{
+    if (lines == NULL || *lines == NULL)
+        return;
+
+    iftFree((*lines)->val);
+    iftFree(*lines);
+    *lines = NULL;
+}
+
+
+iftRadonLineArray *iftExtractRadonLines(const iftImage *R, const iftImage *img, int k, int radius, int min_value)
+{
+    if (k <= 0)
+        iftError("Invalid number of lines: %d", "iftExtractRadonLines", k);
+    if (radius < 0)
+        iftError("Invalid suppression radius: %d", "iftExtractRadonLines", radius);
+
+    /* bounded min-heap of the best k peaks: node s is a slot and value[s] the peak it holds */
+    double *value = iftAllocDoubleArray(k);
+    int *bin      = iftAllocIntArray(k);
+    iftDHeap *H   = iftCreateDHeap(k, value);
+    iftSetRemovalPolicyDHeap(H, MINVALUE);
+    int nslots = 0;
+
+    for (int rho = 0; rho < R->ysize; rho++)
+        for (int theta = 0; theta < R->xsize; theta++) {
+            int val = iftImgVal2D(R, theta, rho);
+
+            /* cheap rejections first, the suppression window only for candidates */
+            if ((val < min_value) || (nslots == k && val <= value[H->node[0]]))
+                continue;
+            if (!iftRadonIsPeak(R, theta, rho, radius))
+                continue;
+
+            int s = (nslots < k) ? nslots++ : iftRemoveDHeap(H);
+            value[s] = val;
+            bin[s]   = theta + R->tby[rho];
+            iftInsertDHeap(H, s);
+        }
+
+    iftRadonLineArray *lines = (iftRadonLineArray *) iftAlloc(1, sizeof(iftRadonLineArray));
+    lines->n   = nslots;
+    lines->val = (iftRadonLine *) iftAlloc(iftMax(nslots, 1), sizeof(iftRadonLine));
+
+    /* the heap yields the weakest peak first; the segment is the ray actually traced for the bin */
+    iftArena *arena = iftCreateArena(0);
+    for (int i = nslots - 1; i >= 0; i--) {
+        int s = iftRemoveDHeap(H);
+        iftRadonLine *line = &lines->val[i];
+        line->theta = bin[s] % R->xsize;
+        line->rho   = bin[s] / R->xsize;
+        line->value = (int) value[s];
+
+        iftRadonRay ray;
+        iftResetArena(arena);
+        iftRadonComputeRays(img->xsize, img->ysize, line->theta, line->rho, 1, &ray, arena);
+        line->p1 = ray.p1;
+        line->pn = ray.pn;
+    }
+    iftRadonDestroyArena(&arena);
+
+    iftDestroyDHeap(&H);
+    iftFree(value);
+    iftFree(bin);
+
+    return lines;
+}
+
+
+iftRadonLineArray *iftDetectRadonLines(const iftImage *img, int k, int radius, int min_value)
+{
+    iftImage *R = iftFastRadonTransform(img);
+    iftRadonLineArray *lines = iftExtractRadonLines(R, img, k, radius, min_value);
+    iftDestroyImage(&R);
+
+    return lines;
+}
@@ -0,0 +1,128 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "iftRadonInternal.h"
+
+/*
+ * NUMA topology from sysfs (/sys/devices/system/node), so that no library is required. Hosts without it
+ * (or with a single node) are seen as one node holding every CPU.
+ */
+
+static int ift_radon_numa_nnodes = 1;
+/* OS id of each node */
+static int ift_radon_numa_id[IFT_RADON_NUMA_MAX_NODES];
+/* node (index) of each CPU */
+static int ift_radon_numa_cpu_node[CPU_SETSIZE];
+static cpu_set_t ift_radon_numa_cpus[IFT_RADON_NUMA_MAX_NODES];
+static pthread_once_t ift_radon_numa_once = PTHREAD_ONCE_INIT;
+
+
+/* parses a sysfs list ("0-3,8,10-11") into a CPU set; returns false if the file cannot be read */
+static bool iftRadonNumaReadList(const char *path, cpu_set_t *set)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+        return false;
+
+    CPU_ZERO(set);
+    int begin, end;
+    while (fscanf(fp, "%d", &begin) == 1) {
+        end = begin;
+        int c = fgetc(fp);
+        if (c == '-') {
+            if (fscanf(fp, "%d", &end) != 1)
+                break;
+            c = fgetc(fp);
+        }
+        for (int i = begin; (i <= end) && (i < CPU_SETSIZE); i++)
+            CPU_SET(i, set);
+        if (c != ',')
+            break;
+    }
+    fclose(fp);
+
+    return true;
+}
+
+
+static void iftRadonNumaInit(void)
+{
+    cpu_set_t online;
+    ift_radon_numa_nnodes = 0;
+
+    if (iftRadonNumaReadList("/sys/devices/system/node/online", &online)) {
+        for (int id = 0; (id < CPU_SETSIZE) && (ift_radon_numa_nnodes < IFT_RADON_NUMA_MAX_NODES); id++) {
+            if (!CPU_ISSET(id, &online))
+                continue;
+            char path[IFT_STR_DEFAULT_SIZE];
+            sprintf(path, "/sys/devices/system/node/node%d/cpulist", id);
+            cpu_set_t *cpus = &ift_radon_numa_cpus[ift_radon_numa_nnodes];
+            /* memory-only nodes run no threads */
+            if (!iftRadonNumaReadList(path, cpus) || (CPU_COUNT(cpus) == 0))
+                continue;
+            ift_radon_numa_id[ift_radon_numa_nnodes++] = id;
+        }
+    }
+
+    if (ift_radon_numa_nnodes == 0) {
+        ift_radon_numa_nnodes = 1;
+        ift_radon_numa_id[0]  = 0;
+        CPU_ZERO(&ift_radon_numa_cpus[0]);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            CPU_SET(cpu, &ift_radon_numa_cpus[0]);
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        ift_radon_numa_cpu_node[cpu] = 0;
+        for (int k = 0; k < ift_radon_numa_nnodes; k++)
+            if (CPU_ISSET(cpu, &ift_radon_numa_cpus[k])) {
+                ift_radon_numa_cpu_node[cpu] = k;
+                break;
+            }
+    }
+}
+
+
+int iftRadonNumaNumberOfNodes(void)
+{
+    pthread_once(&ift_radon_numa_once, iftRadonNumaInit);
+    return ift_radon_numa_nnodes;
+}
+
+
+bool iftRadonNumaPinThread(int node)
+{
+    pthread_once(&ift_radon_numa_once, iftRadonNumaInit);
+    return sched_setaffinity(0, sizeof(cpu_set_t), &ift_radon_numa_cpus[node]) == 0;
+}
+
+
+int iftRadonNumaCurrentNode(void)
+{
+    pthread_once(&ift_radon_numa_once, iftRadonNumaInit);
+    int cpu = sched_getcpu();
+
+    return ((cpu >= 0) && (cpu < CPU_SETSIZE)) ? ift_radon_numa_cpu_node[cpu] : 0;
+}
+
+
+int iftRadonNumaNodeOfAddress(const void *ptr)
+{
+    pthread_once(&ift_radon_numa_once, iftRadonNumaInit);
+    if (ift_radon_numa_nnodes == 1)
+        return 0;
+
+#ifdef SYS_move_pages
+    /* move_pages() without target nodes only reports where the pages are */
+    void *page = (void *) ((uintptr_t) ptr & ~((uintptr_t) sysconf(_SC_PAGESIZE) - 1));
+    int status = -1;
+    if ((syscall(SYS_move_pages, 0, 1UL, &page, NULL, &status, 0) == 0) && (status >= 0))
+        for (int k = 0; k < ift_radon_numa_nnodes; k++)
+            if (ift_radon_numa_id[k] == status)
+                return k;
+#endif
+
+    return -1;
+}
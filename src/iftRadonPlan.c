@@ -0,0 +1,903 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "iftRadonPlan.h"
+#include "iftRadonInternal.h"
+
+/* number of tiles the plan aims at: about 10 per angle, so that the thieves find work until the end */
+#define IFT_RADON_PLAN_TILES     2048
+/* minimum number of bins of a tile */
+#define IFT_RADON_PLAN_TILE_BINS 8
+
+/* plan files of the cache: "RDNP" and the version of their layout (3: the rays of the column angles transposed) */
+#define IFT_RADON_PLAN_FILE_MAGIC   0x524E4450
+#define IFT_RADON_PLAN_FILE_VERSION 3
+/* alignment of the arrays of a plan file */
+#define IFT_RADON_PLAN_FILE_ALIGN   64
+
+
+/* consecutive bins of one angle, traced by one task */
+typedef struct {
+    int theta, first, nrays;
+} iftRadonTile;
+
+
+struct ift_radon_plan {
+    int xsize, ysize, nbins;
+    /** Row offsets of the input: tby[y] = y * xsize. */
+    int *tby;
+    /** Row offsets of the transposed input: tbyt[x] = x * ysize. */
+    int *tbyt;
+    /**
+     * Clipped ray of each bin: rays[theta * nbins + rho]. The rays of the column angles (see
+     * iftRadonIsColumnAngle()) are transposed, to be traced along the rows of the transposed input.
+     */
+    iftRadonRay *rays;
+    int nthreads;
+    iftRadonSchedule schedule;
+    bool numa;
+    /** Tiles in angle order and the prefix sums of their costs: cost[t] of the tiles before t. */
+    iftRadonTile *tiles;
+    long *cost;
+    int ntiles;
+    /** Prefix sums of the costs of the bins over all the angles: bin_cost[rho] of the bins before rho. */
+    long *bin_cost;
+    /** Mapping of the plan file holding rays, tiles, cost and bin_cost, or NULL if the plan owns them. */
+    void *mapping;
+    size_t mapping_size;
+    /** Valid rays and pixels read by each execution (for the statistics). */
+    long nrays, nsamples;
+};
+
+
+/* header of a plan file, followed by its arrays at the given offsets */
+typedef struct {
+    uint32_t magic, version;
+    /* CPU features the library was built with (see iftRadonPlanFeatures()) */
+    uint32_t features;
+    int32_t xsize, ysize, nangles, nbins, ntiles;
+    int64_t nrays, nsamples;
+    uint64_t rays_offset, tiles_offset, cost_offset, bin_cost_offset, size;
+} iftRadonPlanFileHeader;
+
+
+/* pixels read by a ray: the cost of its traversal */
+static inline long iftRadonRayCost(const iftRadonRay *ray)
+{
+    return ray->valid ? iftMax(1, iftMax(abs(ray->pn.x - ray->p1.x), abs(ray->pn.y - ray->p1.y))) : 0;
+}
+
+
+/*
+ * Splits the bins of each angle into tiles of about nsamples / IFT_RADON_PLAN_TILES pixels. The rays near the
+ * ends of the detector only cut the image corners, so the tiles there span more bins.
+ */
+static void iftRadonCreatePlanTiles(iftRadonPlan *plan)
+{
+    long target = iftMax(1, plan->nsamples / IFT_RADON_PLAN_TILES);
+    int max_tiles = IFT_RADON_NANGLES * ((plan->nbins + IFT_RADON_PLAN_TILE_BINS - 1) / IFT_RADON_PLAN_TILE_BINS);
+
+    plan->tiles  = (iftRadonTile *) iftAlloc(max_tiles, sizeof(iftRadonTile));
+    plan->cost   = (long *) iftAlloc(max_tiles + 1, sizeof(long));
+    plan->ntiles = 0;
+
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        const iftRadonRay *rays = &plan->rays[theta * plan->nbins];
+        for (int first = 0; first < plan->nbins; ) {
+            int last = first;
+            long cost = iftRadonRayCost(&rays[first]);
+            while ((last + 1 < plan->nbins) && ((cost < target) || (last - first + 1 < IFT_RADON_PLAN_TILE_BINS)))
+                cost += iftRadonRayCost(&rays[++last]);
+
+            plan->tiles[plan->ntiles] = (iftRadonTile) {.theta = theta, .first = first, .nrays = last - first + 1};
+            plan->cost[plan->ntiles + 1] = plan->cost[plan->ntiles] + cost;
+            plan->ntiles++;
+            first = last + 1;
+        }
+    }
+}
+
+
+/*
+ * State of one execution. queue[i] packs the range [head, tail) of order[] left to thread i (head in the
+ * high 32 bits): the owner pops the head, so it walks its angles in order, and a thief takes the tail. Both
+ * only move their end of the range by a compare-and-swap.
+ *
+ * In NUMA mode, the threads are split into nnodes groups of consecutive threads, pinned to one node each.
+ * Every node owns a range of bins of the same cost, i.e., a band of sinogram rows, and its threads trace
+ * the tiles of that band from a node-local replica of the input. Thieves try their own node first.
+ */
+typedef struct {
+    int nthreads, nnodes;
+    _Atomic uint64_t *queue;
+    /* tiles in queue order */
+    int *order;
+    /* first thread of each node (nnodes + 1 entries) */
+    int *node_thread;
+    /* input of the threads of each node, allocated by the first thread of the node when it is a copy */
+    void **replica;
+    const void *in;
+    size_t size;
+} iftRadonExecution;
+
+
+static iftRadonExecution *iftRadonCreateExecution(const iftRadonPlan *plan, const void *in, size_t size)
+{
+    iftRadonExecution *exec = (iftRadonExecution *) iftAlloc(1, sizeof(iftRadonExecution));
+    exec->nthreads    = plan->nthreads;
+    exec->nnodes      = plan->numa ? iftMin(iftRadonNumaNumberOfNodes(), plan->nthreads) : 1;
+    exec->queue       = (_Atomic uint64_t *) iftAlloc(exec->nthreads, sizeof(_Atomic uint64_t));
+    exec->order       = iftAllocIntArray(plan->ntiles);
+    exec->node_thread = iftAllocIntArray(exec->nnodes + 1);
+    exec->replica     = (void **) iftAlloc(exec->nnodes, sizeof(void *));
+    exec->in          = in;
+    exec->size        = size;
+
+    for (int k = 0; k <= exec->nnodes; k++)
+        exec->node_thread[k] = (k * exec->nthreads + exec->nnodes - 1) / exec->nnodes;
+
+    /* tiles of each node: the band of rows of the same cost, in angle order */
+    int *node_tiles = iftAllocIntArray(exec->nnodes + 1), *tile_node = iftAllocIntArray(plan->ntiles);
+    for (int t = 0, k = 0; t < plan->ntiles; t++) {
+        long rho_cost = plan->bin_cost[plan->tiles[t].first];
+        for (k = 0; (k + 1 < exec->nnodes) && (rho_cost >= plan->bin_cost[plan->nbins] * (k + 1) / exec->nnodes); k++);
+        tile_node[t] = k;
+        node_tiles[k + 1]++;
+    }
+    for (int k = 0; k < exec->nnodes; k++)
+        node_tiles[k + 1] += node_tiles[k];
+    int *next = iftAllocIntArray(exec->nnodes);
+    for (int t = 0; t < plan->ntiles; t++)
+        exec->order[node_tiles[tile_node[t]] + next[tile_node[t]]++] = t;
+
+    /* contiguous ranges of the same estimated cost for the threads of each node */
+    for (int k = 0; k < exec->nnodes; k++) {
+        int head = node_tiles[k], nthreads = exec->node_thread[k + 1] - exec->node_thread[k];
+        long total = 0, acc = 0;
+        for (int j = node_tiles[k]; j < node_tiles[k + 1]; j++)
+            total += plan->cost[exec->order[j] + 1] - plan->cost[exec->order[j]];
+
+        for (int i = 0; i < nthreads; i++) {
+            int tail = head;
+            long end_cost = total * (i + 1) / nthreads;
+            while (tail < node_tiles[k + 1]) {
+                long cost = plan->cost[exec->order[tail] + 1] - plan->cost[exec->order[tail]];
+                if (acc + cost > end_cost)
+                    break;
+                acc += cost;
+                tail++;
+            }
+            if (i == nthreads - 1)
+                tail = node_tiles[k + 1];
+            atomic_init(&exec->queue[exec->node_thread[k] + i], ((uint64_t) head << 32) | (uint32_t) tail);
+            head = tail;
+        }
+    }
+
+    iftFree(node_tiles);
+    iftFree(tile_node);
+    iftFree(next);
+
+    return exec;
+}
+
+
+static void iftRadonDestroyExecution(iftRadonExecution **exec)
+{
+    for (int k = 0; k < (*exec)->nnodes; k++)
+        if ((*exec)->replica[k] != (*exec)->in)
+            iftFree((*exec)->replica[k]);
+    iftFree((void *) (*exec)->queue);
+    iftFree((*exec)->order);
+    iftFree((*exec)->node_thread);
+    iftFree((*exec)->replica);
+    iftFree(*exec);
+    *exec = NULL;
+}
+
+
+/* node of thread i */
+static inline int iftRadonThreadNode(const iftRadonExecution *exec, int i)
+{
+    int k = 0;
+    while (exec->node_thread[k + 1] <= i)
+        k++;
+    return k;
+}
+
+
+/*
+ * Called by every thread of the team before tracing: pins the thread to its node and returns the input it
+ * reads. The first thread of each node copies the input, so its pages are first touched on that node.
+ */
+static void *iftRadonStartExecutionThread(const iftRadonPlan *plan, iftRadonExecution *exec, int i)
+{
+    int k = iftRadonThreadNode(exec, i);
+
+    if (plan->numa)
+        iftRadonNumaPinThread(k);
+
+    if (exec->nnodes == 1)
+        return (void *) exec->in;
+
+    if (i == exec->node_thread[k]) {
+        exec->replica[k] = iftAlloc(exec->size, 1);
+        memcpy(exec->replica[k], exec->in, exec->size);
+    }
+    #pragma omp barrier
+
+    return exec->replica[k];
+}
+
+
+/* next tile of thread i: its own head, or the tail stolen from a thread of its node, then of the others */
+static int iftRadonNextTile(iftRadonExecution *exec, int i)
+{
+    _Atomic uint64_t *queue = exec->queue;
+    uint64_t range = atomic_load(&queue[i]);
+    while ((range >> 32) < (uint32_t) range)
+        if (atomic_compare_exchange_weak(&queue[i], &range, range + ((uint64_t) 1 << 32)))
+            return exec->order[range >> 32];
+
+    int k = iftRadonThreadNode(exec, i), begin = exec->node_thread[k], n = exec->node_thread[k + 1] - begin;
+    for (int j = 1; j < exec->nthreads; j++) {
+        /* the threads of the node after i, then the threads of the next nodes */
+        int victim = (j < n) ? begin + (i - begin + j) % n : (exec->node_thread[k + 1] + j - n) % exec->nthreads;
+        range = atomic_load(&queue[victim]);
+        while ((range >> 32) < (uint32_t) range)
+            if (atomic_compare_exchange_weak(&queue[victim], &range, range - 1))
+                return exec->order[(uint32_t) range - 1];
+    }
+
+    return -1;
+}
+
+
+/* pixels read by the rays */
+static long iftRadonRaysCost(const iftRadonRay *rays, int nrays)
+{
+    long cost = 0;
+    for (int p = 0; p < nrays; p++)
+        cost += iftRadonRayCost(&rays[p]);
+    return cost;
+}
+
+
+/*
+ * Counts the samples of a tile read from another node than the thread's and its bins written to another node
+ * (statistics only). The node of the input and of the bins is the node of their first page.
+ */
+static inline void iftRadonCountRemote(const iftRadonPlan *plan, const void *src, int theta, int first, int nrays,
+                                       const int *dst, long *remote_samples, long *remote_bins)
+{
+    if (ift_radon_stats_verbosity == 0)
+        return;
+
+    int node = iftRadonNumaCurrentNode(), src_node = iftRadonNumaNodeOfAddress(src);
+    int dst_node = iftRadonNumaNodeOfAddress(dst);
+    if ((src_node >= 0) && (src_node != node))
+        *remote_samples += iftRadonRaysCost(&plan->rays[theta * plan->nbins + first], nrays);
+    if ((dst_node >= 0) && (dst_node != node))
+        *remote_bins += nrays;
+}
+
+
+int iftRadonAPIVersion(void)
+{
+    return IFT_RADON_API_VERSION;
+}
+
+
+/* plan without its rays and tiles */
+static iftRadonPlan *iftRadonAllocPlan(int xsize, int ysize)
+{
+    iftRadonPlan *plan = (iftRadonPlan *) iftAlloc(1, sizeof(iftRadonPlan));
+    plan->xsize    = xsize;
+    plan->ysize    = ysize;
+    plan->nbins    = (int) sqrt(xsize*xsize + ysize*ysize);
+    plan->nthreads = omp_get_max_threads();
+    plan->schedule = IFT_RADON_SCHEDULE_STEALING;
+    plan->numa     = false;
+    plan->mapping  = NULL;
+
+    plan->tby = iftAllocIntArray(ysize);
+    for (int y = 0; y < ysize; y++)
+        plan->tby[y] = y * xsize;
+    plan->tbyt = iftAllocIntArray(xsize);
+    for (int x = 0; x < xsize; x++)
+        plan->tbyt[x] = x * ysize;
+
+    return plan;
+}
+
+
+/*
+ * Instruction sets the library was built with: the compiler may contract the float clipping into FMAs, so
+ * the rays of a plan file are only reused by builds with the same features.
+ */
+static uint32_t iftRadonPlanFeatures(void)
+{
+    uint32_t features = 0;
+#ifdef __SSE4_1__
+    features |= 1 << 0;
+#endif
+#ifdef __AVX__
+    features |= 1 << 1;
+#endif
+#ifdef __AVX2__
+    features |= 1 << 2;
+#endif
+#ifdef __FMA__
+    features |= 1 << 3;
+#endif
+#ifdef __AVX512F__
+    features |= 1 << 4;
+#endif
+#ifdef __ARM_NEON
+    features |= 1 << 5;
+#endif
+#ifdef IFT_RADON_REFERENCE_KERNEL
+    features |= 1 << 6;
+#endif
+    return features;
+}
+
+
+/* file of the plan in the cache: the key is the image size, the angles, the detector bins and the features */
+static char *iftRadonPlanFilename(const char *dir, int xsize, int ysize)
+{
+    char name[IFT_STR_DEFAULT_SIZE];
+    sprintf(name, "radon-%dx%d-a%d-b%d-f%x-v%d.plan", xsize, ysize, IFT_RADON_NANGLES,
+            (int) sqrt(xsize*xsize + ysize*ysize), iftRadonPlanFeatures(), IFT_RADON_PLAN_FILE_VERSION);
+
+    return iftJoinPathnames(dir, name);
+}
+
+
+static inline uint64_t iftRadonPlanFileAlign(uint64_t offset)
+{
+    return (offset + IFT_RADON_PLAN_FILE_ALIGN - 1) / IFT_RADON_PLAN_FILE_ALIGN * IFT_RADON_PLAN_FILE_ALIGN;
+}
+
+
+/* whether the section [offset, offset + n * sz) of a file of the given size is aligned and inside the file */
+static bool iftRadonPlanFileHasSection(uint64_t offset, uint64_t n, uint64_t sz, uint64_t size)
+{
+    return (offset % IFT_RADON_PLAN_FILE_ALIGN == 0) && (offset >= sizeof(iftRadonPlanFileHeader)) &&
+           (offset <= size) && (n <= (size - offset) / sz);
+}
+
+
+/*
+ * Whether the header and the arrays of a mapped plan file are consistent with the plan of its size: every
+ * section lies inside the file, the tiles cover the bins of every angle in order, the prefix sums start at
+ * zero and never decrease, and the valid rays have their endpoints inside the image (the transposed image for
+ * the column angles). A truncated, corrupted
+ * or foreign file in a shared cache would otherwise make the executions read out of bounds.
+ */
+static bool iftRadonPlanFileIsValid(const iftRadonPlanFileHeader *header, const void *mapping, uint64_t size,
+                                    const iftRadonPlan *plan)
+{
+    uint64_t nrays = (uint64_t) IFT_RADON_NANGLES * plan->nbins;
+    int max_tiles = IFT_RADON_NANGLES * ((plan->nbins + IFT_RADON_PLAN_TILE_BINS - 1) / IFT_RADON_PLAN_TILE_BINS);
+
+    if ((header->size != size) || (header->ntiles < IFT_RADON_NANGLES) || (header->ntiles > max_tiles) ||
+        (header->nrays < 0) || (header->nsamples < 0) ||
+        !iftRadonPlanFileHasSection(header->rays_offset, nrays, sizeof(iftRadonRay), size) ||
+        !iftRadonPlanFileHasSection(header->tiles_offset, header->ntiles, sizeof(iftRadonTile), size) ||
+        !iftRadonPlanFileHasSection(header->cost_offset, header->ntiles + 1, sizeof(long), size) ||
+        !iftRadonPlanFileHasSection(header->bin_cost_offset, plan->nbins + 1, sizeof(long), size))
+        return false;
+
+    const iftRadonTile *tiles = (const iftRadonTile *) ((const char *) mapping + header->tiles_offset);
+    const long *cost = (const long *) ((const char *) mapping + header->cost_offset);
+    const long *bin_cost = (const long *) ((const char *) mapping + header->bin_cost_offset);
+    int theta = 0, next = 0;
+    for (int t = 0; t < header->ntiles; t++) {
+        if ((next == plan->nbins) && (tiles[t].first == 0)) {
+            theta++;
+            next = 0;
+        }
+        if ((tiles[t].theta != theta) || (tiles[t].first != next) || (tiles[t].nrays < 1) ||
+            (tiles[t].nrays > plan->nbins - next) || (cost[t + 1] < cost[t]))
+            return false;
+        next += tiles[t].nrays;
+    }
+    if ((theta != IFT_RADON_NANGLES - 1) || (next != plan->nbins) || (cost[0] != 0) || (bin_cost[0] != 0))
+        return false;
+    for (int rho = 0; rho < plan->nbins; rho++)
+        if (bin_cost[rho + 1] < bin_cost[rho])
+            return false;
+
+    const iftRadonRay *rays = (const iftRadonRay *) ((const char *) mapping + header->rays_offset);
+    for (uint64_t i = 0; i < nrays; i++) {
+        bool transposed = iftRadonIsColumnAngle(i / plan->nbins);
+        int xsize = transposed ? plan->ysize : plan->xsize, ysize = transposed ? plan->xsize : plan->ysize;
+        if (rays[i].valid && ((rays[i].p1.x < 0) || (rays[i].p1.x >= xsize) || (rays[i].p1.y < 0) ||
+                              (rays[i].p1.y >= ysize) || (rays[i].pn.x < 0) || (rays[i].pn.x >= xsize) ||
+                              (rays[i].pn.y < 0) || (rays[i].pn.y >= ysize)))
+            return false;
+    }
+
+    return true;
+}
+
+
+/* maps the plan file, or returns NULL if it is missing or does not match the plan (e.g., a stale file) */
+static iftRadonPlan *iftRadonMapPlan(const char *path, int xsize, int ysize)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    void *mapping = MAP_FAILED;
+    if ((fstat(fd, &st) == 0) && ((size_t) st.st_size >= sizeof(iftRadonPlanFileHeader)))
+        mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return NULL;
+
+    const iftRadonPlanFileHeader *header = (const iftRadonPlanFileHeader *) mapping;
+    iftRadonPlan *plan = iftRadonAllocPlan(xsize, ysize);
+    if ((header->magic != IFT_RADON_PLAN_FILE_MAGIC) || (header->version != IFT_RADON_PLAN_FILE_VERSION) ||
+        (header->features != iftRadonPlanFeatures()) || (header->xsize != xsize) || (header->ysize != ysize) ||
+        (header->nangles != IFT_RADON_NANGLES) || (header->nbins != plan->nbins) ||
+        !iftRadonPlanFileIsValid(header, mapping, st.st_size, plan)) {
+        munmap(mapping, st.st_size);
+        iftDestroyRadonPlan(&plan);
+        return NULL;
+    }
+
+    plan->mapping      = mapping;
+    plan->mapping_size = st.st_size;
+    plan->rays         = (iftRadonRay *) ((char *) mapping + header->rays_offset);
+    plan->tiles        = (iftRadonTile *) ((char *) mapping + header->tiles_offset);
+    plan->cost         = (long *) ((char *) mapping + header->cost_offset);
+    plan->bin_cost     = (long *) ((char *) mapping + header->bin_cost_offset);
+    plan->ntiles       = header->ntiles;
+    plan->nrays        = header->nrays;
+    plan->nsamples     = header->nsamples;
+
+    return plan;
+}
+
+
+/* writes the plan file through a temporary file, so that concurrent processes never map a partial file */
+static void iftRadonWritePlanFile(const iftRadonPlan *plan, const char *path)
+{
+    iftRadonPlanFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic    = IFT_RADON_PLAN_FILE_MAGIC;
+    header.version  = IFT_RADON_PLAN_FILE_VERSION;
+    header.features = iftRadonPlanFeatures();
+    header.xsize    = plan->xsize;
+    header.ysize    = plan->ysize;
+    header.nangles  = IFT_RADON_NANGLES;
+    header.nbins    = plan->nbins;
+    header.ntiles   = plan->ntiles;
+    header.nrays    = plan->nrays;
+    header.nsamples = plan->nsamples;
+
+    const void *array[4] = {plan->rays, plan->tiles, plan->cost, plan->bin_cost};
+    uint64_t size[4]     = {(uint64_t) IFT_RADON_NANGLES * plan->nbins * sizeof(iftRadonRay),
+                            (uint64_t) plan->ntiles * sizeof(iftRadonTile),
+                            (uint64_t) (plan->ntiles + 1) * sizeof(long),
+                            (uint64_t) (plan->nbins + 1) * sizeof(long)};
+    uint64_t *offset[4]  = {&header.rays_offset, &header.tiles_offset, &header.cost_offset, &header.bin_cost_offset};
+    header.size = iftRadonPlanFileAlign(sizeof(header));
+    for (int i = 0; i < 4; i++) {
+        *offset[i]  = header.size;
+        header.size = iftRadonPlanFileAlign(header.size + size[i]);
+    }
+
+    char *tmp = iftAllocCharArray(strlen(path) + 32);
+    sprintf(tmp, "%s.%d.tmp", path, (int) getpid());
+    FILE *fp = fopen(tmp, "wb");
+    if (fp == NULL) {
+        iftFree(tmp);
+        return;
+    }
+
+    static const char zeros[IFT_RADON_PLAN_FILE_ALIGN] = {0};
+    bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1);
+    uint64_t pos = sizeof(header);
+    for (int i = 0; (i < 4) && ok; i++) {
+        ok &= (fwrite(zeros, 1, *offset[i] - pos, fp) == *offset[i] - pos);
+        ok &= (fwrite(array[i], 1, size[i], fp) == size[i]);
+        pos = *offset[i] + size[i];
+    }
+    ok &= (fwrite(zeros, 1, header.size - pos, fp) == header.size - pos);
+    ok &= (fclose(fp) == 0);
+
+    if (!ok || (rename(tmp, path) != 0))
+        unlink(tmp);
+    iftFree(tmp);
+}
+
+
+iftRadonPlan *iftCreateRadonPlan(int xsize, int ysize)
+{
+    if ((xsize <= 0) || (ysize <= 0))
+        iftError("Invalid image size: (%d, %d)", "iftCreateRadonPlan", xsize, ysize);
+
+    iftRadonPlan *plan = iftRadonAllocPlan(xsize, ysize);
+    plan->rays = (iftRadonRay *) iftAlloc((size_t) IFT_RADON_NANGLES * plan->nbins, sizeof(iftRadonRay));
+
+    #pragma omp parallel num_threads(plan->nthreads)
+    {
+        iftArena *arena = iftCreateArena(0);
+
+        #pragma omp for
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            double tic = iftRadonStatsTic();
+            iftResetArena(arena);
+            iftRadonRay *rays = &plan->rays[theta * plan->nbins];
+            iftRadonComputeRays(xsize, ysize, theta, 0, plan->nbins, rays, arena);
+            if (iftRadonIsColumnAngle(theta))
+                iftRadonTransposeRays(rays, plan->nbins, rays);
+            iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+        }
+
+        iftRadonDestroyArena(&arena);
+    }
+
+    plan->bin_cost = (long *) iftAlloc(plan->nbins + 1, sizeof(long));
+    for (long i = 0; i < (long) IFT_RADON_NANGLES * plan->nbins; i++) {
+        plan->nrays    += plan->rays[i].valid;
+        plan->nsamples += iftRadonRayCost(&plan->rays[i]);
+        plan->bin_cost[i % plan->nbins + 1] += iftRadonRayCost(&plan->rays[i]);
+    }
+    for (int rho = 0; rho < plan->nbins; rho++)
+        plan->bin_cost[rho + 1] += plan->bin_cost[rho];
+    iftRadonCreatePlanTiles(plan);
+
+    return plan;
+}
+
+
+/*
+ * Creates the cache directory and its missing parents, returning whether it exists. Unlike iftMakeDir(), it
+ * never exits: read-only parents, permissions and other processes creating the same directory are not errors.
+ */
+static bool iftRadonMakeCacheDir(const char *dir)
+{
+    char *prefix = iftCopyString(dir);
+
+    for (char *c = prefix + 1; *c != '\0'; c++)
+        if (*c == '/') {
+            *c = '\0';
+            mkdir(prefix, 0777);
+            *c = '/';
+        }
+    bool exists = (mkdir(prefix, 0777) == 0) || (errno == EEXIST);
+    iftFree(prefix);
+
+    return exists;
+}
+
+
+iftRadonPlan *iftCreateCachedRadonPlan(const char *dir, int xsize, int ysize)
+{
+    if ((xsize <= 0) || (ysize <= 0))
+        iftError("Invalid image size: (%d, %d)", "iftCreateCachedRadonPlan", xsize, ysize);
+
+    char *path = iftRadonPlanFilename(dir, xsize, ysize);
+
+    double tic = iftRadonStatsTic();
+    iftRadonPlan *plan = iftRadonMapPlan(path, xsize, ysize);
+    iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+
+    if (plan == NULL) {
+        plan = iftCreateRadonPlan(xsize, ysize);
+        if (iftRadonMakeCacheDir(dir))
+            iftRadonWritePlanFile(plan, path);
+    }
+    iftFree(path);
+
+    return plan;
+}
+
+
+void iftDestroyRadonPlan(iftRadonPlan **plan)
+{
+    if (plan == NULL || *plan == NULL)
+        return;
+
+    iftFree((*plan)->tby);
+    iftFree((*plan)->tbyt);
+    if ((*plan)->mapping != NULL)
+        munmap((*plan)->mapping, (*plan)->mapping_size);
+    else {
+        iftFree((*plan)->rays);
+        iftFree((*plan)->tiles);
+        iftFree((*plan)->cost);
+        iftFree((*plan)->bin_cost);
+    }
+    iftFree(*plan);
+    *plan = NULL;
+}
+
+
+int iftRadonPlanNumberOfBins(const iftRadonPlan *plan)
+{
+    return plan->nbins;
+}
+
+
+size_t iftRadonPlanOutputSize(const iftRadonPlan *plan)
+{
+    return (size_t) IFT_RADON_NANGLES * plan->nbins;
+}
+
+
+void iftSetRadonPlanNumberOfThreads(iftRadonPlan *plan, int nthreads)
+{
+    if (nthreads < 1)
+        iftError("Invalid number of threads: %d", "iftSetRadonPlanNumberOfThreads", nthreads);
+
+    plan->nthreads = nthreads;
+}
+
+
+int iftRadonPlanNumberOfThreads(const iftRadonPlan *plan)
+{
+    return plan->nthreads;
+}
+
+
+void iftSetRadonPlanSchedule(iftRadonPlan *plan, iftRadonSchedule schedule)
+{
+    if ((schedule != IFT_RADON_SCHEDULE_STEALING) && (schedule != IFT_RADON_SCHEDULE_STATIC))
+        iftError("Invalid schedule: %d", "iftSetRadonPlanSchedule", schedule);
+
+    plan->schedule = schedule;
+}
+
+
+iftRadonSchedule iftRadonPlanSchedule(const iftRadonPlan *plan)
+{
+    return plan->schedule;
+}
+
+
+void iftSetRadonPlanNuma(iftRadonPlan *plan, bool numa)
+{
+    plan->numa = numa;
+}
+
+
+bool iftRadonPlanNuma(const iftRadonPlan *plan)
+{
+    return plan->numa;
+}
+
+
+/*
+ * Runs the statement trace for the bins first..first+nrays-1 of the angle theta, over all the bins of the plan:
+ * in tiles stolen among the threads, or in whole angles statically split among them. The statement reads
+ * the n pixels of the input in from src (a replica in NUMA mode) and writes the first bin to dst.
+ */
+#define iftRadonScheduleTiles(plan, in, n, src, theta, first, nrays, dst, trace)                             \
+    do {                                                                                                     \
+        iftRadonExecution *exec_ = iftRadonCreateExecution((plan), (in), (n) * sizeof(*(in)));              \
+        _Pragma("omp parallel num_threads((plan)->nthreads)")                                                \
+        {                                                                                                    \
+            __typeof__(in) src = iftRadonStartExecutionThread((plan), exec_, omp_get_thread_num());          \
+            long remote_samples_ = 0, remote_bins_ = 0;                                                      \
+            if ((plan)->schedule == IFT_RADON_SCHEDULE_STATIC) {                                             \
+                _Pragma("omp for schedule(static)")                                                          \
+                for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {                                    \
+                    int first = 0, nrays = (plan)->nbins;                                                    \
+                    trace;                                                                                   \
+                    iftRadonCountRemote((plan), src, theta, first, nrays, (dst), &remote_samples_,           \
+                                        &remote_bins_);                                                      \
+                }                                                                                            \
+            } else {                                                                                         \
+                int t_;                                                                                      \
+                while ((t_ = iftRadonNextTile(exec_, omp_get_thread_num())) >= 0) {                          \
+                    int theta = (plan)->tiles[t_].theta, first = (plan)->tiles[t_].first;                    \
+                    int nrays = (plan)->tiles[t_].nrays;                                                     \
+                    trace;                                                                                   \
+                    iftRadonCountRemote((plan), src, theta, first, nrays, (dst), &remote_samples_,           \
+                                        &remote_bins_);                                                      \
+                }                                                                                            \
+            }                                                                                                \
+            iftRadonStatsCount(IFT_RADON_COUNTER_REMOTE_SAMPLES, remote_samples_);                           \
+            iftRadonStatsCount(IFT_RADON_COUNTER_REMOTE_BINS, remote_bins_);                                 \
+        }                                                                                                    \
+        iftRadonDestroyExecution(&exec_);                                                                    \
+    } while (0)
+
+
+/*
+ * out[rho * IFT_RADON_NANGLES + theta], the rays summed by project (iftRadonProjectRays or a kernel of its own).
+ * The input is the image followed by its transpose (iftRadonCopyWithTranspose()), whose rows are read by the
+ * transposed rays of the column angles.
+ */
+#define iftRadonExecutePlanWith(plan, in, out, project)                                                      \
+    do {                                                                                                     \
+        double tic = iftRadonStatsTic();                                                                     \
+        size_t n_ = (size_t) (plan)->xsize * (plan)->ysize;                                                  \
+        iftRadonScheduleTiles(plan, in, 2 * n_, src, theta, first, nrays,                                    \
+                              &(out)[first * IFT_RADON_NANGLES + theta],                                     \
+                              project(iftRadonIsColumnAngle(theta) ? &src[n_] : src,                         \
+                                      iftRadonIsColumnAngle(theta) ? (plan)->tbyt : (plan)->tby,             \
+                                      &(plan)->rays[theta * (plan)->nbins + first], nrays,                   \
+                                      &(out)[first * IFT_RADON_NANGLES + theta], IFT_RADON_NANGLES));        \
+        iftRadonStatsToc(IFT_RADON_STAGE_TRAVERSAL, tic);                                                    \
+        iftRadonStatsCount(IFT_RADON_COUNTER_RAYS, (plan)->nrays);                                           \
+        iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, (plan)->nsamples);                                     \
+    } while (0)
+
+#define iftRadonExecutePlan(plan, in, out) iftRadonExecutePlanWith(plan, in, out, iftRadonProjectRays)
+
+/* copies the image in to buf, followed by its transpose */
+#define iftRadonCopyWithTranspose(buf, in, xsize, ysize)                     \
+    do {                                                                     \
+        size_t n_ = (size_t) (xsize) * (ysize);                              \
+        for (size_t p_ = 0; p_ < n_; p_++)                                   \
+            (buf)[p_] = (in)[p_];                                            \
+        iftRadonTranspose(&(buf)[n_], (in), (xsize), (ysize));               \
+    } while (0)
+
+
+void iftExecuteRadonPlan(const iftRadonPlan *plan, const int *in, int *out)
+{
+    size_t n = (size_t) plan->xsize * plan->ysize;
+    iftRadonPixelType type = iftRadonPixelTypeOf(in, n, plan->xsize, plan->ysize);
+
+    if (type == IFT_RADON_UINT8) {
+        uchar *u8 = iftAllocUCharArray(2 * n);
+        iftRadonCopyWithTranspose(u8, in, plan->xsize, plan->ysize);
+        iftRadonExecutePlan(plan, u8, out);
+        iftFree(u8);
+        return;
+    }
+    if (type == IFT_RADON_UINT16) {
+        ushort *u16 = iftAllocUShortArray(2 * n);
+        iftRadonCopyWithTranspose(u16, in, plan->xsize, plan->ysize);
+        iftRadonExecutePlan(plan, u16, out);
+        iftFree(u16);
+        return;
+    }
+
+    int *i32 = iftAllocIntArray(2 * n);
+    iftRadonCopyWithTranspose(i32, in, plan->xsize, plan->ysize);
+    if (iftRadonFixedStepFits(plan->xsize, plan->ysize))
+        iftRadonExecutePlan(plan, i32, out);
+    else
+        iftRadonExecutePlanWith(plan, i32, out, iftRadonProjectRays_i32f);
+    iftFree(i32);
+}
+
+
+/* the reference kernel, and the images too large for the fixed-point positions, read int32 pixels only */
+#define iftRadonExecuteNarrowPlan(plan, in, type, alloc, out)                 \
+    do {                                                                      \
+        size_t n = (size_t) (plan)->xsize * (plan)->ysize;                    \
+        if (iftRadonFixedStepFits((plan)->xsize, (plan)->ysize)) {            \
+            type *buf = alloc(2 * n);                                         \
+            iftRadonCopyWithTranspose(buf, in, (plan)->xsize, (plan)->ysize); \
+            iftRadonExecutePlan(plan, buf, out);                              \
+            iftFree(buf);                                                     \
+            break;                                                            \
+        }                                                                     \
+        int *i32 = iftAllocIntArray(2 * n);                                   \
+        iftRadonCopyWithTranspose(i32, in, (plan)->xsize, (plan)->ysize);     \
+        iftRadonExecutePlanWith(plan, i32, out, iftRadonProjectRays_i32f);    \
+        iftFree(i32);                                                         \
+    } while (0)
+
+
+void iftExecuteRadonPlanU8(const iftRadonPlan *plan, const uchar *in, int *out)
+{
+    iftRadonExecuteNarrowPlan(plan, in, uchar, iftAllocUCharArray, out);
+}
+
+
+void iftExecuteRadonPlanU16(const iftRadonPlan *plan, const ushort *in, int *out)
+{
+    iftRadonExecuteNarrowPlan(plan, in, ushort, iftAllocUShortArray, out);
+}
+
+
+/* iftRadonExecutePlan() for nimgs interleaved images, followed by their interleaved transposes */
+#define iftRadonExecutePlanBatch(plan, in, nimgs, out)                                                       \
+    do {                                                                                                     \
+        double tic = iftRadonStatsTic();                                                                     \
+        size_t n_ = (size_t) (plan)->xsize * (plan)->ysize * IFT_RADON_BATCH;                                \
+        iftRadonScheduleTiles(plan, in, 2 * n_, src, theta, first, nrays,                                    \
+                              &(out)[0][first * IFT_RADON_NANGLES + theta],                                  \
+                              iftRadonProjectRaysBatch(iftRadonIsColumnAngle(theta) ? &src[n_] : src,        \
+                                                       (nimgs),                                              \
+                                                       iftRadonIsColumnAngle(theta) ? (plan)->tbyt           \
+                                                                                    : (plan)->tby,           \
+                                                       &(plan)->rays[theta * (plan)->nbins + first], nrays,  \
+                                                       (out), first * IFT_RADON_NANGLES + theta,             \
+                                                       IFT_RADON_NANGLES));                                  \
+        iftRadonStatsToc(IFT_RADON_STAGE_TRAVERSAL, tic);                                                    \
+        iftRadonStatsCount(IFT_RADON_COUNTER_RAYS, (plan)->nrays);                                           \
+        iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, (plan)->nsamples);                                     \
+    } while (0)
+
+/*
+ * interleaves the images in[idx[0..nimgs-1]] pixel by pixel into buf, zero-padded to IFT_RADON_BATCH lanes, and
+ * their transposes after them
+ */
+#define iftRadonInterleave(buf, in, idx, nimgs, xsize, ysize)                                          \
+    do {                                                                                               \
+        size_t n_ = (size_t) (xsize) * (ysize);                                                        \
+        for (size_t p_ = 0; p_ < n_; p_++)                                                             \
+            for (int k_ = 0; k_ < (nimgs); k_++)                                                       \
+                (buf)[p_ * IFT_RADON_BATCH + k_] = (in)[(idx)[k_]][p_];                                \
+        for (int y_ = 0; y_ < (ysize); y_++)                                                           \
+            for (int x_ = 0; x_ < (xsize); x_++)                                                       \
+                for (int k_ = 0; k_ < (nimgs); k_++)                                                   \
+                    (buf)[(n_ + (size_t) x_ * (ysize) + y_) * IFT_RADON_BATCH + k_] =                  \
+                        (in)[(idx)[k_]][(size_t) y_ * (xsize) + x_];                                   \
+    } while (0)
+
+
+void iftExecuteRadonPlanBatch(const iftRadonPlan *plan, const int * const *in, int nimgs, int **out)
+{
+    if (nimgs < 1)
+        iftError("Invalid number of images: %d", "iftExecuteRadonPlanBatch", nimgs);
+
+    /* the reference kernel has no batched traversal */
+    if (!iftRadonFixedStepFits(plan->xsize, plan->ysize)) {
+        for (int i = 0; i < nimgs; i++)
+            iftExecuteRadonPlan(plan, in[i], out[i]);
+        return;
+    }
+
+    size_t n = (size_t) plan->xsize * plan->ysize;
+
+    /* kernel of each image, as in iftExecuteRadonPlan() */
+    iftRadonPixelType *type = (iftRadonPixelType *) iftAlloc(nimgs, sizeof(iftRadonPixelType));
+    for (int i = 0; i < nimgs; i++)
+        type[i] = iftRadonPixelTypeOf(in[i], n, plan->xsize, plan->ysize);
+
+    /*
+     * All kernels share the fixed-point samples, so the images are traced in the given order, up to
+     * IFT_RADON_BATCH per traversal, and each group is read with the widest pixel type of its images. The
+     * traversal always works on IFT_RADON_BATCH lanes, so a few leftover images are cheaper one by one.
+     */
+    int idx[IFT_RADON_BATCH], *chunk_out[IFT_RADON_BATCH];
+    for (int next = 0; next < nimgs; ) {
+        int k = 0;
+        iftRadonPixelType widest = IFT_RADON_UINT8;
+        for (; (next < nimgs) && (k < IFT_RADON_BATCH); next++, k++) {
+            idx[k]       = next;
+            chunk_out[k] = out[next];
+            /* the enumeration goes from the widest type to the narrowest */
+            widest = iftMin(widest, type[next]);
+        }
+
+        /* a traversal costs about as much as 4 single images (see IFT_RADON_BATCH) */
+        if (k < IFT_RADON_BATCH / 4) {
+            for (int i = 0; i < k; i++)
+                iftExecuteRadonPlan(plan, in[idx[i]], chunk_out[i]);
+        } else if (widest == IFT_RADON_INT32) {
+            int *buf = iftAllocIntArray(2 * n * IFT_RADON_BATCH);
+            iftRadonInterleave(buf, in, idx, k, plan->xsize, plan->ysize);
+            iftRadonExecutePlanBatch(plan, buf, k, chunk_out);
+            iftFree(buf);
+        } else if (widest == IFT_RADON_UINT8) {
+            uchar *buf = iftAllocUCharArray(2 * n * IFT_RADON_BATCH);
+            iftRadonInterleave(buf, in, idx, k, plan->xsize, plan->ysize);
+            iftRadonExecutePlanBatch(plan, buf, k, chunk_out);
+            iftFree(buf);
+        } else {
+            ushort *buf = iftAllocUShortArray(2 * n * IFT_RADON_BATCH);
+            iftRadonInterleave(buf, in, idx, k, plan->xsize, plan->ysize);
+            iftRadonExecutePlanBatch(plan, buf, k, chunk_out);
+            iftFree(buf);
+        }
+    }
+
+    iftFree(type);
+}
@@ -0,0 +1,107 @@
+#include "iftRadonPyramid.h"
+#include "iftInterpolation.h"
+
+
+iftRadonPyramid *iftCreateRadonPyramid(const iftImage *img, int nlevels)
+{
+    if (nlevels < 1)
+        iftError("Invalid number of levels: %d", "iftCreateRadonPyramid", nlevels);
+    if ((1 << (nlevels - 1)) >= IFT_RADON_NANGLES)
+        iftError("Too many levels (%d): the angle step of the coarsest level exceeds %d degrees",
+                 "iftCreateRadonPyramid", nlevels, IFT_RADON_NANGLES);
+    if (iftMin(img->xsize, img->ysize) / (1 << (nlevels - 1)) < IFT_RADON_PYRAMID_MIN_SIZE)
+        iftError("Too many levels (%d) for an image of size (%d, %d)", "iftCreateRadonPyramid",
+                 nlevels, img->xsize, img->ysize);
+
+    iftRadonPyramid *pyr = (iftRadonPyramid *) iftAlloc(1, sizeof(iftRadonPyramid));
+    pyr->nlevels    = nlevels;
+    pyr->img        = (iftImage **) iftAlloc(nlevels, sizeof(iftImage *));
+    pyr->R          = (iftImage **) iftAlloc(nlevels, sizeof(iftImage *));
+    pyr->angle_step = iftAllocIntArray(nlevels);
+
+    pyr->img[0] = iftCopyImage(img);
+    for (int l = 0; l < nlevels; l++) {
+        if (l > 0)
+            pyr->img[l] = iftResizeImage(pyr->img[l - 1], pyr->img[l - 1]->xsize / 2, pyr->img[l - 1]->ysize / 2, 1);
+        pyr->R[l]          = iftCreateImage(IFT_RADON_NANGLES, iftRadonNumberOfBins(pyr->img[l]), 1);
+        pyr->angle_step[l] = 1 << l;
+    }
+
+    int top = nlevels - 1;
+    iftBoundingBox all = {.begin = {0, 0, 0}, .end = {IFT_RADON_NANGLES - 1, pyr->R[top]->ysize - 1, 0}};
+    iftRefineRadonPyramid(pyr, top, &all, 1);
+
+    return pyr;
+}
+
+
+void iftDestroyRadonPyramid(iftRadonPyramid **pyr)
+{
+    if (pyr == NULL || *pyr == NULL)
+        return;
+
+    for (int l = 0; l < (*pyr)->nlevels; l++) {
+        iftDestroyImage(&(*pyr)->img[l]);
+        iftDestroyImage(&(*pyr)->R[l]);
+    }
+    iftFree((*pyr)->img);
+    iftFree((*pyr)->R);
+    iftFree((*pyr)->angle_step);
+    iftFree(*pyr);
+    *pyr = NULL;
+}
+
+
+void iftRefineRadonPyramid(iftRadonPyramid *pyr, int level, const iftBoundingBox *windows, int nwindows)
+{
+    if ((level < 0) || (level >= pyr->nlevels))
+        iftError("Invalid level %d: the pyramid has %d levels", "iftRefineRadonPyramid", level, pyr->nlevels);
+
+    /* one tile per decimated angle of each window */
+    int step = pyr->angle_step[level];
+    int ntiles = 0;
+    for (int w = 0; w < nwindows; w++)
+        ntiles += iftMax(0, windows[w].end.x - windows[w].begin.x + 1) / step + 1;
+
+    iftBoundingBox *tiles = (iftBoundingBox *) iftAlloc(iftMax(ntiles, 1), sizeof(iftBoundingBox));
+    ntiles = 0;
+    for (int w = 0; w < nwindows; w++) {
+        int theta_begin = iftMax(windows[w].begin.x, 0);
+        int theta_end   = iftMin(windows[w].end.x, IFT_RADON_NANGLES - 1);
+        int first       = ((theta_begin + step - 1) / step) * step;
+
+        for (int theta = first; theta <= theta_end; theta += step) {
+            tiles[ntiles].begin.x = tiles[ntiles].end.x = theta;
+            tiles[ntiles].begin.y = windows[w].begin.y;
+            tiles[ntiles].end.y   = windows[w].end.y;
+            tiles[ntiles].begin.z = tiles[ntiles].end.z = 0;
+            ntiles++;
+        }
+    }
+
+    if (ntiles > 0)
+        iftFastRadonTransformTilesInPlace(pyr->img[level], tiles, ntiles, pyr->R[level]);
+    iftFree(tiles);
+}
+
+
+iftBoundingBox iftMapRadonPyramidWindow(const iftRadonPyramid *pyr, iftBoundingBox window, int from_level,
+                                        int to_level)
+{
+    if ((from_level < 0) || (from_level >= pyr->nlevels) || (to_level < 0) || (to_level >= pyr->nlevels))
+        iftError("Invalid levels (%d, %d): the pyramid has %d levels", "iftMapRadonPyramidWindow",
+                 from_level, to_level, pyr->nlevels);
+
+    int nbins_from = pyr->R[from_level]->ysize;
+    int nbins_to   = pyr->R[to_level]->ysize;
+    float scale    = (float) nbins_to / nbins_from;
+
+    iftBoundingBox mapped;
+    mapped.begin.x = iftMax(window.begin.x, 0);
+    mapped.end.x   = iftMin(window.end.x, IFT_RADON_NANGLES - 1);
+    mapped.begin.y = iftMax(0, (int) floor((window.begin.y - nbins_from / 2.0) * scale + nbins_to / 2.0));
+    mapped.end.y   = iftMin(nbins_to - 1, (int) ceil((window.end.y + 1 - nbins_from / 2.0) * scale + nbins_to / 2.0) - 1);
+    mapped.begin.z = mapped.end.z = 0;
+
+    return mapped;
+}
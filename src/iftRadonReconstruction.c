@@ -0,0 +1,563 @@
+#include "iftRadonReconstruction.h"
+#include "iftRadonFFT.h"
+#include "iftRadonStats.h"
+
+/* samples per grid cell of the tabulated Kaiser-Bessel kernel */
+#define IFT_RADON_GRIDDING_TABLE_STEPS 512
+/* maximum side of the sub-images back-projected directly by the hierarchical back-projection */
+#define IFT_RADON_HIERARCHICAL_LEAF 8
+/* minimum side of the sub-images whose quadrants are back-projected as separate OpenMP tasks */
+#define IFT_RADON_HIERARCHICAL_TASK 64
+/* samples per bin of the projections of the hierarchical back-projection: each level interpolates them
+   again, which would blur the image at one sample per bin */
+#define IFT_RADON_HIERARCHICAL_OVERSAMPLING 2
+
+
+/*
+ * Sub-image of the hierarchical back-projection: the pixels [x0, x0 + nx) x [y0, y0 + ny), whose center is at
+ * (cu, cv) from the image center, and its projections: nangles x nsamples values, the sample i of the angle a
+ * at s0 + i / IFT_RADON_HIERARCHICAL_OVERSAMPLING from the center of the sub-image along the direction
+ * (cos_theta[a], sin_theta[a]).
+ */
+typedef struct {
+    int x0, y0, nx, ny;
+    double cu, cv;
+    int nangles, nsamples;
+    double s0;
+    double *cos_theta, *sin_theta;
+    float *q;
+} iftRadonSubImage;
+
+
+/* checks that R is a sinogram of an image of xsize x ysize pixels */
+static void iftRadonCheckSinogram(const iftImage *R, int xsize, int ysize, const char *function)
+{
+    int nbins = (int) sqrt(xsize*xsize + ysize*ysize);
+
+    if ((xsize < 1) || (ysize < 1))
+        iftError("Invalid image size: (%d, %d)", function, xsize, ysize);
+    if ((R->xsize != IFT_RADON_NANGLES) || (R->ysize != nbins))
+        iftError("Sinogram size (%d, %d) does not match the image: expected (%d, %d)", function, R->xsize,
+                 R->ysize, IFT_RADON_NANGLES, nbins);
+}
+
+
+/* direction of the angle theta and the number of ray samples per unit length, which the projections are
+   divided by to become line integrals */
+static void iftRadonAngleGeometry(int theta, double *cos_theta, double *sin_theta, double *density)
+{
+    *cos_theta = cos(theta * IFT_PI / 180.0);
+    *sin_theta = sin(theta * IFT_PI / 180.0);
+    *density   = iftMax(fabs(*cos_theta), fabs(*sin_theta));
+}
+
+
+iftFImage *iftRadonFilteredBackProjection(const iftImage *R, int xsize, int ysize)
+{
+    iftRadonCheckSinogram(R, xsize, ysize, "iftRadonFilteredBackProjection");
+
+    double tic = iftRadonStatsTic();
+    iftFImage *Q = iftRadonRampFilter(R);
+    iftRadonStatsToc(IFT_RADON_STAGE_FILTERING, tic);
+
+    int nbins = R->ysize;
+    double D = sqrt(xsize*xsize + ysize*ysize), cx = xsize / 2.0, cy = ysize / 2.0;
+
+    /* each angle covers pi / NANGLES of the half circle */
+    double *cos_theta = iftAllocDoubleArray(IFT_RADON_NANGLES), *sin_theta = iftAllocDoubleArray(IFT_RADON_NANGLES);
+    double *weight = iftAllocDoubleArray(IFT_RADON_NANGLES);
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        double density;
+        iftRadonAngleGeometry(theta, &cos_theta[theta], &sin_theta[theta], &density);
+        weight[theta] = IFT_PI / (IFT_RADON_NANGLES * density);
+    }
+
+    /* the pixel (x, y) falls on the (fractional) bin D/2 - 1/2 + (x + 1 - cx) cos + (y + 1 - cy) sin */
+    tic = iftRadonStatsTic();
+    iftFImage *img = iftCreateFImage(xsize, ysize, 1);
+    #pragma omp parallel for schedule(dynamic)
+    for (int y = 0; y < ysize; y++) {
+        float *row = &img->val[y * xsize];
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            double c = cos_theta[theta], w = weight[theta];
+            double pos = D / 2.0 - 0.5 + (1 - cx) * c + (y + 1 - cy) * sin_theta[theta];
+            for (int x = 0; x < xsize; x++, pos += c) {
+                int b = (int) floor(pos);
+                double frac = pos - b;
+                if ((b >= 0) && (b + 1 < nbins))
+                    row[x] += w * ((1 - frac) * iftImgVal2D(Q, theta, b) + frac * iftImgVal2D(Q, theta, b + 1));
+            }
+        }
+    }
+    iftRadonStatsToc(IFT_RADON_STAGE_BACKPROJECTION, tic);
+    iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, (long) IFT_RADON_NANGLES * xsize * ysize);
+
+    iftFree(cos_theta);
+    iftFree(sin_theta);
+    iftFree(weight);
+    iftDestroyFImage(&Q);
+
+    return img;
+}
+
+
+static void iftRadonDestroySubImage(iftRadonSubImage *sub)
+{
+    iftFree(sub->cos_theta);
+    iftFree(sub->sin_theta);
+    iftFree(sub->q);
+}
+
+
+/* sub-image of the pixels [x0, x0 + nx) x [y0, y0 + ny) of an image of xsize x ysize, with nangles projections
+   covering its diameter */
+static iftRadonSubImage iftRadonCreateSubImage(int x0, int y0, int nx, int ny, int xsize, int ysize, int nangles)
+{
+    int half = (int) ceil((sqrt(nx*nx + ny*ny) / 2.0 + 1) * IFT_RADON_HIERARCHICAL_OVERSAMPLING);
+    iftRadonSubImage sub = {.x0 = x0, .y0 = y0, .nx = nx, .ny = ny, .nangles = nangles,
+                            .nsamples = 2 * half + 1, .s0 = (double) -half / IFT_RADON_HIERARCHICAL_OVERSAMPLING};
+
+    /* the pixel x is at x + 1 - xsize / 2 from the image center (see iftSparseRadonTransform()) */
+    sub.cu = x0 + (nx - 1) / 2.0 + 1 - xsize / 2.0;
+    sub.cv = y0 + (ny - 1) / 2.0 + 1 - ysize / 2.0;
+    sub.cos_theta = iftAllocDoubleArray(nangles);
+    sub.sin_theta = iftAllocDoubleArray(nangles);
+    sub.q = iftAllocFloatArray((size_t) nangles * sub.nsamples);
+
+    return sub;
+}
+
+
+/* value of the projection q (n samples) at the fractional sample pos, linearly interpolated (0 outside) */
+static inline float iftRadonInterpolateProjection(const float *q, int n, double pos)
+{
+    int i = (int) floor(pos);
+    float frac = pos - i;
+
+    if ((i < 0) || (i + 1 >= n))
+        return 0;
+    return (1 - frac) * q[i] + frac * q[i + 1];
+}
+
+
+/*
+ * Adds w times the projection q (n samples) resampled at pos, pos + 1, ..., pos + m - 1 to out, by cubic
+ * (Catmull-Rom) interpolation. The fraction of the positions is the same for all of them, so it is a 4-tap
+ * filter over the samples (0 near the ends of q).
+ */
+static void iftRadonResampleProjection(const float *q, int n, double pos, float w, float *out, int m)
+{
+    int first = (int) floor(pos);
+    float t = pos - first;
+    float w0 = w * 0.5f * ((-t + 2) * t - 1) * t, w1 = w * 0.5f * ((3 * t - 5) * t * t + 2);
+    float w2 = w * 0.5f * ((-3 * t + 4) * t + 1) * t, w3 = w * 0.5f * (t - 1) * t * t;
+
+    /* the outputs i with all the taps q[first + i - 1 .. first + i + 2] inside q */
+    int begin = iftMax(1 - first, 0), end = iftMin(n - 2 - first, m);
+    for (int i = begin, j = first + begin; i < end; i++, j++)
+        out[i] += w0 * q[j - 1] + w1 * q[j] + w2 * q[j + 1] + w3 * q[j + 2];
+}
+
+
+/*
+ * Projections of a quadrant from those of its parent, each shifted to the center of the quadrant. When
+ * decimate is set, the quadrant keeps the even angles of the parent, and each odd angle is split between its
+ * two neighbors (a triangular filter along the angles, so that the merged projections keep the weight of the
+ * parent's).
+ */
+static void iftRadonShiftProjections(const iftRadonSubImage *parent, iftRadonSubImage *sub, bool decimate)
+{
+    int reach = decimate ? 1 : 0;
+    long nsamples = 0;
+
+    for (int a = 0; a < sub->nangles; a++) {
+        int center = (reach + 1) * a;
+        float *q = &sub->q[(size_t) a * sub->nsamples];
+
+        sub->cos_theta[a] = parent->cos_theta[center];
+        sub->sin_theta[a] = parent->sin_theta[center];
+
+        for (int b = iftMax(center - reach, 0); b <= iftMin(center + reach, parent->nangles - 1); b++) {
+            /* the last odd angle has a single neighbor */
+            float w = ((b == center) || ((b > center) && (a + 1 == sub->nangles))) ? 1 : 0.5;
+
+            /* the sample i of the quadrant is the sample pos + i of the parent */
+            const float *qp = &parent->q[(size_t) b * parent->nsamples];
+            double shift = (sub->cu - parent->cu) * parent->cos_theta[b] + (sub->cv - parent->cv) * parent->sin_theta[b];
+            double pos = (sub->s0 + shift - parent->s0) * IFT_RADON_HIERARCHICAL_OVERSAMPLING;
+            iftRadonResampleProjection(qp, parent->nsamples, pos, w, q, sub->nsamples);
+            nsamples += sub->nsamples;
+        }
+    }
+    iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, nsamples);
+}
+
+
+/* back-projects the projections of a sub-image over its pixels */
+static void iftRadonBackProjectSubImage(const iftRadonSubImage *sub, int xsize, int ysize, iftFImage *img)
+{
+    for (int y = sub->y0; y < sub->y0 + sub->ny; y++) {
+        float *row = &img->val[y * img->xsize];
+        double v = y + 1 - ysize / 2.0 - sub->cv, u = sub->x0 + 1 - xsize / 2.0 - sub->cu;
+        for (int a = 0; a < sub->nangles; a++) {
+            const float *q = &sub->q[(size_t) a * sub->nsamples];
+            double c = sub->cos_theta[a] * IFT_RADON_HIERARCHICAL_OVERSAMPLING;
+            double pos = (u * sub->cos_theta[a] + v * sub->sin_theta[a] - sub->s0) * IFT_RADON_HIERARCHICAL_OVERSAMPLING;
+            for (int x = sub->x0; x < sub->x0 + sub->nx; x++, pos += c)
+                row[x] += iftRadonInterpolateProjection(q, sub->nsamples, pos);
+        }
+    }
+    iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, (long) sub->nangles * sub->nx * sub->ny);
+}
+
+
+/* splits a sub-image into (up to) 4 quadrants, with the angles they keep, and returns their number */
+static int iftRadonSplitSubImage(const iftRadonSubImage *sub, int xsize, int ysize, double accuracy,
+                                 iftRadonSubImage quadrant[4], bool decimate[4])
+{
+    int nx[2] = {(sub->nx + 1) / 2, sub->nx / 2}, ny[2] = {(sub->ny + 1) / 2, sub->ny / 2};
+    int n = 0;
+
+    for (int j = 0; j < 2; j++)
+        for (int i = 0; i < 2; i++) {
+            if ((nx[i] == 0) || (ny[j] == 0))
+                continue;
+            /* a quadrant of side m keeps half the angles if they are at least accuracy * m / 2 */
+            int nangles = (sub->nangles + 1) / 2;
+            decimate[n] = (nangles >= accuracy * iftMax(nx[i], ny[j]) / 2);
+            if (!decimate[n])
+                nangles = sub->nangles;
+            quadrant[n] = iftRadonCreateSubImage(sub->x0 + i * nx[0], sub->y0 + j * ny[0], nx[i], ny[j], xsize,
+                                                 ysize, nangles);
+            n++;
+        }
+
+    return n;
+}
+
+
+/*
+ * The quadrants write disjoint pixels, so those of the large sub-images are back-projected by separate tasks,
+ * down to sub-images of side IFT_RADON_HIERARCHICAL_TASK. The projections of sub are kept until its tasks end.
+ */
+static void iftRadonHierarchicalBackProjectSubImage(const iftRadonSubImage *sub, int xsize, int ysize,
+                                                    double accuracy, iftFImage *img)
+{
+    if (iftMax(sub->nx, sub->ny) <= IFT_RADON_HIERARCHICAL_LEAF) {
+        iftRadonBackProjectSubImage(sub, xsize, ysize, img);
+        return;
+    }
+
+    iftRadonSubImage quadrant[4];
+    bool decimate[4];
+    int n = iftRadonSplitSubImage(sub, xsize, ysize, accuracy, quadrant, decimate);
+    bool tasks = (iftMax(sub->nx, sub->ny) >= IFT_RADON_HIERARCHICAL_TASK);
+    for (int k = 0; k < n; k++) {
+        #pragma omp task if (tasks) shared(quadrant, decimate)
+        {
+            iftRadonShiftProjections(sub, &quadrant[k], decimate[k]);
+            iftRadonHierarchicalBackProjectSubImage(&quadrant[k], xsize, ysize, accuracy, img);
+            iftRadonDestroySubImage(&quadrant[k]);
+        }
+    }
+    #pragma omp taskwait
+}
+
+
+/*
+ * Ramp-filtered projections of the sinogram as the root sub-image (the whole image, centered at the image
+ * center), each one divided by its sampling density and weighted by its share pi / NANGLES of the half
+ * circle. They are interpolated to IFT_RADON_HIERARCHICAL_OVERSAMPLING samples per bin by zero-padding their
+ * spectra, so the sample j is at 1/2 - D/2 + j / IFT_RADON_HIERARCHICAL_OVERSAMPLING.
+ */
+static iftRadonSubImage iftRadonFilteredProjections(const iftImage *R, int xsize, int ysize)
+{
+    int S = IFT_RADON_HIERARCHICAL_OVERSAMPLING;
+    int nbins = R->ysize, L = iftRadonFFTGoodSize(2 * nbins), K = L / 2, KS = S * L / 2;
+    iftRadonSubImage root = iftRadonCreateSubImage(0, 0, xsize, ysize, xsize, ysize, IFT_RADON_NANGLES);
+
+    iftFree(root.q);
+    root.cu = root.cv = 0;
+    root.nsamples = S * nbins;
+    root.s0 = 0.5 - sqrt(xsize*xsize + ysize*ysize) / 2.0;
+    root.q  = iftAllocFloatArray((size_t) IFT_RADON_NANGLES * root.nsamples);
+
+    double *weight = iftAllocDoubleArray(IFT_RADON_NANGLES);
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        double density;
+        iftRadonAngleGeometry(theta, &root.cos_theta[theta], &root.sin_theta[theta], &density);
+        weight[theta] = IFT_PI / (IFT_RADON_NANGLES * density);
+    }
+
+    /* the sinogram rows are the interleaved columns: element rho of the column theta at rho * NANGLES + theta */
+    iftRadonFFT *fft = iftCreateRadonFFT(L);
+    double *p = iftAllocDoubleArray((size_t) S * L * IFT_RADON_NANGLES);
+    double *Pr = iftAllocDoubleArray((size_t) (KS + 1) * IFT_RADON_NANGLES);
+    double *Pi = iftAllocDoubleArray((size_t) (KS + 1) * IFT_RADON_NANGLES);
+    double *H = iftAllocDoubleArray(K + 1);
+    for (int i = 0; i < R->n; i++)
+        p[i] = R->val[i] * weight[i % IFT_RADON_NANGLES];
+    iftExecuteRadonRealFFT(fft, p, Pr, Pi, IFT_RADON_NANGLES);
+    iftRadonRampResponse(fft, H);
+    iftDestroyRadonFFT(&fft);
+
+    /* the frequency K of length L is split between K and S L - K of length S L */
+    for (int k = 0; k <= K; k++)
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            double w = H[k] / L * (((k == K) && (S > 1)) ? 0.5 : 1);
+            Pr[(size_t) k * IFT_RADON_NANGLES + theta] *= w;
+            Pi[(size_t) k * IFT_RADON_NANGLES + theta] *= w;
+        }
+    fft = iftCreateRadonFFT(S * L);
+    iftExecuteRadonInverseRealFFT(fft, Pr, Pi, p, IFT_RADON_NANGLES);
+    iftDestroyRadonFFT(&fft);
+
+    for (int j = 0; j < root.nsamples; j++)
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++)
+            root.q[(size_t) theta * root.nsamples + j] = p[(size_t) j * IFT_RADON_NANGLES + theta];
+
+    iftFree(weight);
+    iftFree(p);
+    iftFree(Pr);
+    iftFree(Pi);
+    iftFree(H);
+
+    return root;
+}
+
+
+iftFImage *iftRadonHierarchicalBackProjection(const iftImage *R, int xsize, int ysize, double accuracy)
+{
+    iftRadonCheckSinogram(R, xsize, ysize, "iftRadonHierarchicalBackProjection");
+    if (accuracy <= 0)
+        iftError("Invalid accuracy: %f (it must be positive)", "iftRadonHierarchicalBackProjection", accuracy);
+
+    double tic = iftRadonStatsTic();
+    iftRadonSubImage root = iftRadonFilteredProjections(R, xsize, ysize);
+    iftRadonStatsToc(IFT_RADON_STAGE_FILTERING, tic);
+
+    /* one thread starts the recursion, the others take its tasks */
+    tic = iftRadonStatsTic();
+    iftFImage *img = iftCreateFImage(xsize, ysize, 1);
+    #pragma omp parallel
+    #pragma omp single
+    iftRadonHierarchicalBackProjectSubImage(&root, xsize, ysize, accuracy, img);
+    iftRadonStatsToc(IFT_RADON_STAGE_BACKPROJECTION, tic);
+
+    iftRadonDestroySubImage(&root);
+
+    return img;
+}
+
+
+/* modified Bessel function of the first kind and order 0, by its power series */
+static double iftRadonBesselI0(double x)
+{
+    double sum = 1, term = 1, q = x * x / 4;
+
+    for (int k = 1; term > 1e-16 * sum; k++) {
+        term *= q / ((double) k * k);
+        sum  += term;
+    }
+
+    return sum;
+}
+
+
+/* Kaiser-Bessel kernel I0(beta sqrt(1 - (2 t / W)^2)) for |t| <= W / 2, tabulated for t >= 0 */
+static double *iftRadonKaiserBesselTable(int W, double beta)
+{
+    int n = W * IFT_RADON_GRIDDING_TABLE_STEPS / 2 + 1;
+    double *table = iftAllocDoubleArray(n);
+
+    for (int i = 0; i < n; i++) {
+        double r = 2.0 * i / (W * IFT_RADON_GRIDDING_TABLE_STEPS);
+        table[i] = iftRadonBesselI0(beta * sqrt(iftMax(1 - r * r, 0)));
+    }
+
+    return table;
+}
+
+
+/* FT of the Kaiser-Bessel kernel at x cycles per grid cell */
+static double iftRadonKaiserBesselFT(int W, double beta, double x)
+{
+    double a = beta * beta - (IFT_PI * W * x) * (IFT_PI * W * x);
+
+    if (a > 1e-12)
+        return W * sinh(sqrt(a)) / sqrt(a);
+    if (a < -1e-12)
+        return W * sin(sqrt(-a)) / sqrt(-a);
+    return W;
+}
+
+
+/*
+ * Adds a polar sample (value re + i im at the grid position gx, gy) to the rows [ybegin, yend) of the
+ * G x G frequency grid (origin at the cell 0, periodic), weighted by the separable kernel: the W x W cells
+ * at a distance in [-W/2, W/2) from the sample along each axis. Only the columns 0..G/2 are stored, since
+ * the grid of a real image is Hermitian.
+ */
+static inline void iftRadonGridSample(double gx, double gy, double re, double im, const double *table, int W,
+                                      int G, int ybegin, int yend, double *grid_re, double *grid_im)
+{
+    int Gh = G / 2 + 1;
+    int x0 = (int) ceil(gx - W / 2.0), y0 = (int) ceil(gy - W / 2.0);
+    double kx[IFT_RADON_GRIDDING_KERNEL_WIDTH];
+
+    /* the rows [y0, y0 + W) wrap around the grid at most once: skips the samples that miss the band */
+    int yw = ((y0 % G) + G) % G;
+    if (((yw >= yend) || (yw + W <= ybegin)) && (yw + W - G <= ybegin))
+        return;
+
+    for (int i = 0; i < W; i++)
+        kx[i] = table[iftRound(fabs(x0 + i - gx) * IFT_RADON_GRIDDING_TABLE_STEPS)];
+
+    for (int j = 0; j < W; j++) {
+        int y = (y0 + j + G) % G;
+        if ((y < ybegin) || (y >= yend))
+            continue;
+        double ky = table[iftRound(fabs(y0 + j - gy) * IFT_RADON_GRIDDING_TABLE_STEPS)];
+        double *row_re = &grid_re[(size_t) y * Gh], *row_im = &grid_im[(size_t) y * Gh];
+        for (int i = 0; i < W; i++) {
+            int x = (x0 + i + G) % G;
+            if (x >= Gh)
+                continue;
+            row_re[x] += re * kx[i] * ky;
+            row_im[x] += im * kx[i] * ky;
+        }
+    }
+}
+
+
+iftFImage *iftRadonGriddingReconstruction(const iftImage *R, int xsize, int ysize)
+{
+    iftRadonCheckSinogram(R, xsize, ysize, "iftRadonGriddingReconstruction");
+
+    int nbins = R->ysize, L = iftRadonFFTGoodSize(2 * nbins), K = L / 2;
+    /* an even grid, so the real FFTs of its rows run at half the length */
+    int G = 2 * iftRadonFFTGoodSize((IFT_RADON_GRIDDING_OVERSAMPLING * iftMax(xsize, ysize) + 1) / 2), Gh = G / 2 + 1;
+    int W = IFT_RADON_GRIDDING_KERNEL_WIDTH;
+    double alpha = IFT_RADON_GRIDDING_OVERSAMPLING;
+    /* kernel shape of Beatty et al. (2005) for the oversampling and the width */
+    double beta = IFT_PI * sqrt((W / alpha) * (W / alpha) * (alpha - 0.5) * (alpha - 0.5) - 0.8);
+    double D = sqrt(xsize*xsize + ysize*ysize);
+
+    /* the grid origin is the pixel (ox, oy), at (dx, dy) from the center of the projections */
+    int ox = xsize / 2, oy = ysize / 2;
+    double dx = ox + 1 - xsize / 2.0, dy = oy + 1 - ysize / 2.0;
+
+    /* projections as line integrals, and their FFTs (the sinogram rows are the interleaved columns) */
+    double tic = iftRadonStatsTic();
+    double *cos_theta = iftAllocDoubleArray(IFT_RADON_NANGLES), *sin_theta = iftAllocDoubleArray(IFT_RADON_NANGLES);
+    double *density = iftAllocDoubleArray(IFT_RADON_NANGLES);
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++)
+        iftRadonAngleGeometry(theta, &cos_theta[theta], &sin_theta[theta], &density[theta]);
+
+    iftRadonFFT *fft = iftCreateRadonFFT(L);
+    double *p = iftAllocDoubleArray((size_t) L * IFT_RADON_NANGLES);
+    double *Pr = iftAllocDoubleArray((size_t) (K + 1) * IFT_RADON_NANGLES);
+    double *Pi = iftAllocDoubleArray((size_t) (K + 1) * IFT_RADON_NANGLES);
+    for (int i = 0; i < R->n; i++)
+        p[i] = R->val[i] / density[i % IFT_RADON_NANGLES];
+    iftExecuteRadonRealFFT(fft, p, Pr, Pi, IFT_RADON_NANGLES);
+    double *H = iftAllocDoubleArray(K + 1);
+    iftRadonRampResponse(fft, H);
+    iftDestroyRadonFFT(&fft);
+    iftFree(p);
+
+    /*
+     * The bin b is at s = b + t from the grid origin along the angle, so the FT of the projection at rho = k / L
+     * is exp(-2 pi i k t / L) FFT[k]. Its polar cell covers |rho| d_rho d_theta, which is weighted by the
+     * response of the ramp filter of the back-projection instead: sampling |rho| itself would bias the
+     * low frequencies, and the mean of the image with them.
+     */
+    double d_theta = IFT_PI / IFT_RADON_NANGLES;
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        double t = 0.5 - D / 2.0 - dx * cos_theta[theta] - dy * sin_theta[theta];
+        for (int k = 0; k <= K; k++) {
+            double area = H[k] / L * d_theta;
+            double phase = -2 * IFT_PI * k * t / L;
+            size_t i = (size_t) k * IFT_RADON_NANGLES + theta;
+            double re = Pr[i], im = Pi[i];
+            Pr[i] = area * (re * cos(phase) - im * sin(phase));
+            Pi[i] = area * (re * sin(phase) + im * cos(phase));
+        }
+    }
+    iftRadonStatsToc(IFT_RADON_STAGE_FILTERING, tic);
+
+    /*
+     * spreads the samples of rho in (-1/2, 1/2) onto the grid: each thread fills its own band of grid rows, and
+     * builds the kernel taps only of the samples whose rows overlap the band
+     */
+    tic = iftRadonStatsTic();
+    double *table = iftRadonKaiserBesselTable(W, beta);
+    double *grid_re = iftAllocDoubleArray((size_t) G * Gh), *grid_im = iftAllocDoubleArray((size_t) G * Gh);
+    #pragma omp parallel
+    {
+        int nthreads = omp_get_num_threads(), id = omp_get_thread_num();
+        int ybegin = (int) ((long) G * id / nthreads), yend = (int) ((long) G * (id + 1) / nthreads);
+
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++)
+            for (int k = 0; k < K; k++) {
+                size_t i = (size_t) k * IFT_RADON_NANGLES + theta;
+                double gx = (double) k * G / L * cos_theta[theta], gy = (double) k * G / L * sin_theta[theta];
+                iftRadonGridSample(gx, gy, Pr[i], Pi[i], table, W, G, ybegin, yend, grid_re, grid_im);
+                /* the projections are real: P(-rho) = conj(P(rho)), which fills the columns near 0 and G/2 */
+                if (k > 0)
+                    iftRadonGridSample(-gx, -gy, Pr[i], -Pi[i], table, W, G, ybegin, yend, grid_re, grid_im);
+            }
+    }
+    iftRadonStatsToc(IFT_RADON_STAGE_GRIDDING, tic);
+    iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, (long) IFT_RADON_NANGLES * (2 * K - 1) * W * W);
+
+    /*
+     * 2D inverse FFT: complex along the stored columns (interleaved), then real along the rows, transposed to
+     * be interleaved as well
+     */
+    tic = iftRadonStatsTic();
+    fft = iftCreateRadonFFT(G);
+    iftExecuteRadonFFT(fft, grid_re, grid_im, Gh, IFT_RADON_FFT_INVERSE);
+    double *tr = iftAllocDoubleArray((size_t) Gh * G), *ti = iftAllocDoubleArray((size_t) Gh * G);
+    for (int y = 0; y < G; y++)
+        for (int x = 0; x < Gh; x++) {
+            tr[(size_t) x * G + y] = grid_re[(size_t) y * Gh + x];
+            ti[(size_t) x * G + y] = grid_im[(size_t) y * Gh + x];
+        }
+    iftFree(grid_re);
+    iftFree(grid_im);
+    double *f = iftAllocDoubleArray((size_t) G * G);
+    iftExecuteRadonInverseRealFFT(fft, tr, ti, f, G);
+    iftDestroyRadonFFT(&fft);
+
+    /* deapodization: the grid was convolved by the kernel, so the image is multiplied by its FT */
+    double *apod_x = iftAllocDoubleArray(xsize), *apod_y = iftAllocDoubleArray(ysize);
+    for (int x = 0; x < xsize; x++)
+        apod_x[x] = iftRadonKaiserBesselFT(W, beta, (double) (x - ox) / G);
+    for (int y = 0; y < ysize; y++)
+        apod_y[y] = iftRadonKaiserBesselFT(W, beta, (double) (y - oy) / G);
+
+    /* the pixel (x, y) is at (x - ox, y - oy) from the origin, and the rows are transposed */
+    iftFImage *img = iftCreateFImage(xsize, ysize, 1);
+    for (int y = 0; y < ysize; y++)
+        for (int x = 0; x < xsize; x++) {
+            int u = (x - ox + G) % G, v = (y - oy + G) % G;
+            iftImgVal2D(img, x, y) = f[(size_t) u * G + v] / (apod_x[x] * apod_y[y]);
+        }
+    iftRadonStatsToc(IFT_RADON_STAGE_INVERSE_FFT, tic);
+
+    iftFree(cos_theta);
+    iftFree(sin_theta);
+    iftFree(density);
+    iftFree(H);
+    iftFree(Pr);
+    iftFree(Pi);
+    iftFree(table);
+    iftFree(tr);
+    iftFree(ti);
+    iftFree(f);
+    iftFree(apod_x);
+    iftFree(apod_y);
+
+    return img;
+}
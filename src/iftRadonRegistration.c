@@ -0,0 +1,262 @@
+#include "iftRadonRegistration.h"
+#include "iftRadonDescriptor.h"
+#include "iftRadonFFT.h"
+#include "iftRadonInternal.h"
+
+/* bin step of the sample used to estimate the offsets of the traced rays */
+#define IFT_RADON_OFFSET_STEP 8
+
+
+/* circular shift s (degrees, with sub-degree precision) maximizing sum_theta f(theta) g(theta + s) */
+static float iftRadonAngularShift(const double *f, const double *g, int n)
+{
+    double *Fr = iftAllocDoubleArray(n), *Fi = iftAllocDoubleArray(n);
+    double *Gr = iftAllocDoubleArray(n), *Gi = iftAllocDoubleArray(n);
+    double fmean = 0, gmean = 0;
+
+    for (int i = 0; i < n; i++) {
+        fmean += f[i] / n;
+        gmean += g[i] / n;
+    }
+    for (int i = 0; i < n; i++) {
+        Fr[i] = f[i] - fmean;
+        Gr[i] = g[i] - gmean;
+    }
+
+    /* correlation theorem: c = IDFT(conj(F) G) */
+    iftRadonFFT *fft = iftCreateRadonFFT(n);
+    iftExecuteRadonFFT(fft, Fr, Fi, 1, IFT_RADON_FFT_FORWARD);
+    iftExecuteRadonFFT(fft, Gr, Gi, 1, IFT_RADON_FFT_FORWARD);
+    for (int i = 0; i < n; i++) {
+        double re = Fr[i] * Gr[i] + Fi[i] * Gi[i];
+        double im = Fr[i] * Gi[i] - Fi[i] * Gr[i];
+        Gr[i] = re;
+        Gi[i] = im;
+    }
+    iftExecuteRadonFFT(fft, Gr, Gi, 1, IFT_RADON_FFT_INVERSE);
+
+    int best = 0;
+    for (int i = 1; i < n; i++)
+        if (Gr[i] > Gr[best])
+            best = i;
+
+    /* parabolic interpolation of the peak */
+    double c0 = Gr[(best + n - 1) % n], c1 = Gr[best], c2 = Gr[(best + 1) % n];
+    double den = c0 - 2 * c1 + c2;
+    float shift = best + ((den < 0) ? 0.5 * (c0 - c2) / den : 0);
+
+    iftDestroyRadonFFT(&fft);
+    iftFree(Fr);
+    iftFree(Fi);
+    iftFree(Gr);
+    iftFree(Gi);
+
+    return shift;
+}
+
+
+/* moments of the sinogram columns: mass, signed distance of the centroid to the image center, and skewness */
+typedef struct {
+    double *mass, *dist, *skew;
+} iftRadonColumnMoments;
+
+
+/*
+ * Offset between the distance of the ray traced for each bin and its nominal distance rho - D/2,
+ * averaged over a sample of the valid bins of each angle (the ray origins are truncated to pixels).
+ */
+static double *iftRadonRayOffsets(const iftImage *img)
+{
+    int nbins = iftRadonNumberOfBins(img);
+    double D  = sqrt(img->xsize * img->xsize + img->ysize * img->ysize);
+    double *offset = iftAllocDoubleArray(IFT_RADON_NANGLES);
+    iftArena *arena = iftCreateArena(0);
+
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+        double a = theta * IFT_PI / 180.0, c = cos(a), s = sin(a);
+        int n = 0;
+
+        /* the rays of all the bins of the angle at once: the matrix of the angle is computed once */
+        iftResetArena(arena);
+        iftRadonRay *rays = (iftRadonRay *) iftArenaAlloc(arena, nbins, sizeof(iftRadonRay));
+        iftRadonComputeRays(img->xsize, img->ysize, theta, 0, nbins, rays, arena);
+
+        for (int rho = 0; rho < nbins; rho += IFT_RADON_OFFSET_STEP) {
+            if (!rays[rho].valid)
+                continue;
+            iftVoxel p1 = rays[rho].p1, pn = rays[rho].pn;
+            double mx = (p1.x + pn.x) / 2.0 - img->xsize / 2.0, my = (p1.y + pn.y) / 2.0 - img->ysize / 2.0;
+            offset[theta] += c * mx + s * my - (rho - D / 2.0);
+            n++;
+        }
+        if (n > 0)
+            offset[theta] /= n;
+    }
+    iftRadonDestroyArena(&arena);
+
+    return offset;
+}
+
+
+static iftRadonColumnMoments iftRadonComputeColumnMoments(const iftImage *R, const double *offset, double D)
+{
+    iftRadonColumnMoments M;
+    M.mass = iftAllocDoubleArray(R->xsize);
+    M.dist = iftAllocDoubleArray(R->xsize);
+    M.skew = iftAllocDoubleArray(R->xsize);
+
+    for (int theta = 0; theta < R->xsize; theta++) {
+        double sum = 0, m1 = 0;
+        for (int rho = 0; rho < R->ysize; rho++) {
+            sum += iftImgVal2D(R, theta, rho);
+            m1  += (double) iftImgVal2D(R, theta, rho) * rho;
+        }
+        if (sum <= 0)
+            continue;
+
+        double centroid = m1 / sum, m2 = 0, m3 = 0;
+        for (int rho = 0; rho < R->ysize; rho++) {
+            double d = rho - centroid, v = iftImgVal2D(R, theta, rho);
+            m2 += v * d * d;
+            m3 += v * d * d * d;
+        }
+        m2 /= sum;
+        m3 /= sum;
+
+        M.mass[theta] = sum;
+        M.dist[theta] = centroid - D / 2.0 + offset[theta];
+        M.skew[theta] = (m2 > IFT_EPSILON) ? m3 / pow(m2, 1.5) : 0;
+    }
+
+    return M;
+}
+
+
+static void iftRadonDestroyColumnMoments(iftRadonColumnMoments *M)
+{
+    iftFree(M->mass);
+    iftFree(M->dist);
+    iftFree(M->skew);
+}
+
+
+/*
+ * Matches the column theta of the fixed sinogram with the column theta + phi of the moving one, for an
+ * integer rotation phi in [0, 360). The columns theta + phi >= 180 are the columns theta + phi - 180
+ * mirrored, which flips the sign of their distances and skewness.
+ *
+ * Fits t to the shifts d(theta) = dist_moving(theta + phi) - dist_fixed(theta) = t . (cos(theta + phi), sin(theta + phi))
+ * and returns the RMS residual of the fit. *skew_err receives the RMS difference of the skewness of the
+ * matched columns, which tells phi from phi + 180.
+ */
+static double iftRadonFitTranslation(const iftRadonColumnMoments *F, const iftRadonColumnMoments *G, int phi,
+                                     iftVector *t, double *skew_err)
+{
+    int n = IFT_RADON_NANGLES;
+    double *d = iftAllocDoubleArray(n);
+    bool *valid = iftAllocBoolArray(n);
+    double scc = 0, scs = 0, sss = 0, scd = 0, ssd = 0, serr = 0;
+    int nvalid = 0;
+
+    for (int theta = 0; theta < n; theta++) {
+        int col = (theta + phi) % (2 * n);
+        double sign = (col >= n) ? -1 : 1;
+        col %= n;
+
+        if ((F->mass[theta] <= 0) || (G->mass[col] <= 0))
+            continue;
+
+        double a = (theta + phi) * IFT_PI / 180.0;
+        double c = cos(a), s = sin(a);
+        double ds = sign * G->skew[col] - F->skew[theta];
+        d[theta] = sign * G->dist[col] - F->dist[theta];
+        valid[theta] = true;
+        scc += c * c;
+        scs += c * s;
+        sss += s * s;
+        scd += c * d[theta];
+        ssd += s * d[theta];
+        serr += ds * ds;
+        nvalid++;
+    }
+
+    /* normal equations of the least-squares fit */
+    double det = scc * sss - scs * scs;
+    t->x = t->y = t->z = 0;
+    if (fabs(det) > IFT_EPSILON) {
+        t->x = (sss * scd - scs * ssd) / det;
+        t->y = (scc * ssd - scs * scd) / det;
+    }
+
+    double err = 0;
+    for (int theta = 0; theta < n; theta++)
+        if (valid[theta]) {
+            double a = (theta + phi) * IFT_PI / 180.0;
+            double r = d[theta] - (t->x * cos(a) + t->y * sin(a));
+            err += r * r;
+        }
+
+    iftFree(d);
+    iftFree(valid);
+
+    *skew_err = (nvalid > 0) ? sqrt(serr / nvalid) : IFT_INFINITY_DBL;
+
+    return (nvalid > 0) ? sqrt(err / nvalid) : IFT_INFINITY_DBL;
+}
+
+
+iftRadonRigidTransform iftRadonRegisterSinograms(const iftImage *R_fixed, const iftImage *R_moving, const iftImage *img)
+{
+    if ((R_fixed->xsize != IFT_RADON_NANGLES) || (R_moving->xsize != IFT_RADON_NANGLES) ||
+        (R_fixed->ysize != iftRadonNumberOfBins(img)) || (R_moving->ysize != iftRadonNumberOfBins(img)))
+        iftError("Sinograms (%d, %d) and (%d, %d) do not match the image domain (%d, %d)", "iftRadonRegisterSinograms",
+                 R_fixed->xsize, R_fixed->ysize, R_moving->xsize, R_moving->ysize, img->xsize, img->ysize);
+
+    /* rotation modulo 180 degrees */
+    double *f = iftRadonSignature(R_fixed);
+    double *g = iftRadonSignature(R_moving);
+    float shift = iftRadonAngularShift(f, g, IFT_RADON_NANGLES);
+    iftFree(f);
+    iftFree(g);
+
+    double D = sqrt(img->xsize * img->xsize + img->ysize * img->ysize);
+    double *offset = iftRadonRayOffsets(img);
+    iftRadonColumnMoments F = iftRadonComputeColumnMoments(R_fixed, offset, D);
+    iftRadonColumnMoments G = iftRadonComputeColumnMoments(R_moving, offset, D);
+
+    /* the profiles have period 180: the skewness of the matched columns decides between phi and phi + 180 */
+    int phi = iftRound(shift) % IFT_RADON_NANGLES;
+    iftVector t0, t1;
+    double skew0, skew1;
+    double err0 = iftRadonFitTranslation(&F, &G, phi, &t0, &skew0);
+    double err1 = iftRadonFitTranslation(&F, &G, phi + IFT_RADON_NANGLES, &t1, &skew1);
+
+    iftRadonRigidTransform T;
+    T.theta    = (skew0 <= skew1) ? shift : shift + IFT_RADON_NANGLES;
+    T.t        = (skew0 <= skew1) ? t0 : t1;
+    T.residual = (skew0 <= skew1) ? err0 : err1;
+    if (T.theta > 180)
+        T.theta -= 360;
+
+    iftRadonDestroyColumnMoments(&F);
+    iftRadonDestroyColumnMoments(&G);
+    iftFree(offset);
+
+    return T;
+}
+
+
+iftRadonRigidTransform iftRadonRegisterImages(const iftImage *fixed, const iftImage *moving)
+{
+    if ((fixed->xsize != moving->xsize) || (fixed->ysize != moving->ysize))
+        iftError("Images of different domains: (%d, %d) and (%d, %d)", "iftRadonRegisterImages",
+                 fixed->xsize, fixed->ysize, moving->xsize, moving->ysize);
+
+    iftImage *R_fixed  = iftFastRadonTransform(fixed);
+    iftImage *R_moving = iftFastRadonTransform(moving);
+    iftRadonRigidTransform T = iftRadonRegisterSinograms(R_fixed, R_moving, fixed);
+    iftDestroyImage(&R_fixed);
+    iftDestroyImage(&R_moving);
+
+    return T;
+}
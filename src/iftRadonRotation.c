@@ -0,0 +1,77 @@
+#include "iftRadon.h"
+#include "iftArena.h"
+#include "iftRadonInternal.h"
+
+
+/* matrix that maps an image pixel to the detector frame of the angle theta */
+static iftMatrix *iftRadonDetectorMatrix(const iftImage *img, int theta, iftArena *arena)
+{
+    iftVector v1 = {.x = -((float)img->xsize / 2.0), .y = -((float)img->ysize / 2.0), .z = 0.0};
+    iftMatrix *transMatrix1 = iftArenaTranslationMatrix(arena, v1);
+
+    iftMatrix *rotMatrix = iftArenaRotationMatrix(arena, IFT_AXIS_Z, theta);
+
+    float D = sqrt(img->xsize*img->xsize + img->ysize*img->ysize);
+    iftVector v2 = {.x = (D / 2.0), .y = (D / 2.0), .z = 0.0};
+    iftMatrix *transMatrix2 = iftArenaTranslationMatrix(arena, v2);
+
+    return iftArenaMultMatrices(arena, iftArenaMultMatrices(arena, transMatrix2, rotMatrix), transMatrix1);
+}
+
+
+static void iftRadonPixelToMatrix(const iftImage *img, int p, iftMatrix *pixMat)
+{
+    iftMatrixElem(pixMat, 0, 0) = p % img->xsize;
+    iftMatrixElem(pixMat, 0, 1) = p / img->xsize;
+    iftMatrixElem(pixMat, 0, 2) = 0;
+    iftMatrixElem(pixMat, 0, 3) = 1;
+}
+
+
+iftImage *iftRotationRadonTransform(const iftImage *img)
+{
+    float D = sqrt(img->xsize*img->xsize + img->ysize*img->ysize);
+    iftImage *R = iftCreateImage(IFT_RADON_NANGLES, D, 1);
+
+#pragma omp parallel
+    {
+        /* per-thread scratch memory for the rotated image and the matrices of each angle */
+        iftArena *arena = iftCreateArena(0);
+
+#pragma omp for
+        for (int theta = 0; theta < IFT_RADON_NANGLES; theta++) {
+            iftResetArena(arena);
+
+            /* compute the translated/rotated image (pixel-wise) */
+            double tic = iftRadonStatsTic();
+            iftMatrix *M = iftRadonDetectorMatrix(img, -theta, arena);
+            iftImage *imgQ = iftArenaCreateImage(arena, D, D, 1);
+            iftMatrix *Ip = iftArenaCreateMatrix(arena, 1, 4);
+            iftMatrix *Iq = iftArenaCreateMatrix(arena, 1, 4);
+            for (int p = 0; p < img->n; p++) {
+                iftRadonPixelToMatrix(img, p, Ip);
+                iftMultMatricesInBuffer(M, Ip, Iq);
+                int x = (int)iftMatrixElem(Iq, 0, 0);
+                int y = (int)iftMatrixElem(Iq, 0, 1);
+                if ((x >= 0) && (x < imgQ->xsize) && (y >= 0) && (y < imgQ->ysize))
+                    iftImgVal2D(imgQ, x, y) = img->val[p];
+            }
+            iftRadonStatsToc(IFT_RADON_STAGE_GEOMETRY, tic);
+
+            /* apply the Radon transform */
+            tic = iftRadonStatsTic();
+            for (int rho = 0; rho < R->ysize; rho++) {
+                int xq = rho;
+                for (int yq = 0; yq < imgQ->ysize; yq++)
+                    iftImgVal2D(R, theta, rho) += iftImgVal2D(imgQ, xq, yq);
+            }
+            iftRadonStatsToc(IFT_RADON_STAGE_TRAVERSAL, tic);
+            iftRadonStatsCount(IFT_RADON_COUNTER_RAYS, R->ysize);
+            iftRadonStatsCount(IFT_RADON_COUNTER_SAMPLES, (long) R->ysize * imgQ->ysize);
+        }
+
+        iftRadonDestroyArena(&arena);
+    }
+
+    return R;
+}
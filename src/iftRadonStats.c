@@ -0,0 +1,192 @@
+#include "iftRadonStats.h"
+#include "iftCSV.h"
+
+
+int ift_radon_stats_verbosity = 0;
+
+static char *ift_radon_stats_path = NULL;
+
+static double ift_radon_stage_time[IFT_RADON_NSTAGES];
+static long ift_radon_stage_calls[IFT_RADON_NSTAGES];
+static long ift_radon_counter[IFT_RADON_NCOUNTERS];
+
+static const char *ift_radon_stage_name[IFT_RADON_NSTAGES] = {
+    "decode", "geometry", "traversal", "normalization", "colormap", "encode", "filtering", "backprojection", "gridding",
+    "inverse_fft", "em_update"
+};
+static const char *ift_radon_counter_name[IFT_RADON_NCOUNTERS] = {
+    "rays", "samples", "allocations", "remote_samples", "remote_bins"
+};
+
+
+void iftSetRadonStatsVerbosity(int verbosity)
+{
+    if ((verbosity < 0) || (verbosity > 2))
+        iftError("Invalid verbosity: %d (it must be 0, 1 or 2)", "iftSetRadonStatsVerbosity", verbosity);
+
+    ift_radon_stats_verbosity = verbosity;
+}
+
+
+void iftResetRadonStats(void)
+{
+    for (int s = 0; s < IFT_RADON_NSTAGES; s++) {
+        ift_radon_stage_time[s]  = 0;
+        ift_radon_stage_calls[s] = 0;
+    }
+    for (int c = 0; c < IFT_RADON_NCOUNTERS; c++)
+        ift_radon_counter[c] = 0;
+}
+
+
+double iftRadonStatsTic(void)
+{
+    return (ift_radon_stats_verbosity > 0) ? omp_get_wtime() : 0;
+}
+
+
+void iftRadonStatsToc(iftRadonStage stage, double tic)
+{
+    if (ift_radon_stats_verbosity == 0)
+        return;
+
+    double elapsed = omp_get_wtime() - tic;
+    #pragma omp atomic
+    ift_radon_stage_time[stage] += elapsed;
+    #pragma omp atomic
+    ift_radon_stage_calls[stage]++;
+}
+
+
+void iftRadonStatsCount(iftRadonCounter counter, long n)
+{
+    if (ift_radon_stats_verbosity == 0)
+        return;
+
+    #pragma omp atomic
+    ift_radon_counter[counter] += n;
+}
+
+
+double iftRadonStatsTime(iftRadonStage stage)
+{
+    return ift_radon_stage_time[stage];
+}
+
+
+long iftRadonStatsCounter(iftRadonCounter counter)
+{
+    return ift_radon_counter[counter];
+}
+
+
+iftJson *iftRadonStatsToJson(void)
+{
+    iftJson *json = iftCreateJsonRoot();
+    char key[64];
+
+    iftAddJDictToJson(json, "stages", iftCreateJDict());
+    for (int s = 0; s < IFT_RADON_NSTAGES; s++) {
+        sprintf(key, "stages:%s", ift_radon_stage_name[s]);
+        iftAddDoubleToJson(json, key, ift_radon_stage_time[s] * 1000.0);
+    }
+
+    /* counters may exceed an int */
+    iftAddJDictToJson(json, "counters", iftCreateJDict());
+    for (int c = 0; c < IFT_RADON_NCOUNTERS; c++) {
+        sprintf(key, "counters:%s", ift_radon_counter_name[c]);
+        iftAddDoubleToJson(json, key, (double) ift_radon_counter[c]);
+    }
+
+    if (ift_radon_stats_verbosity >= 2) {
+        iftAddJDictToJson(json, "calls", iftCreateJDict());
+        for (int s = 0; s < IFT_RADON_NSTAGES; s++) {
+            sprintf(key, "calls:%s", ift_radon_stage_name[s]);
+            iftAddDoubleToJson(json, key, (double) ift_radon_stage_calls[s]);
+        }
+        double traversal = ift_radon_stage_time[IFT_RADON_STAGE_TRAVERSAL];
+        iftAddDoubleToJson(json, "samples_per_second",
+                           (traversal > 0) ? ift_radon_counter[IFT_RADON_COUNTER_SAMPLES] / traversal : 0);
+    }
+
+    return json;
+}
+
+
+void iftWriteRadonStats(const char *path)
+{
+    if (iftEndsWith(path, ".json")) {
+        iftJson *json = iftRadonStatsToJson();
+        iftWriteJson(json, path);
+        iftDestroyJson(&json);
+    } else if (iftEndsWith(path, ".csv")) {
+        int nrows = 1 + IFT_RADON_NSTAGES * ((ift_radon_stats_verbosity >= 2) ? 2 : 1) + IFT_RADON_NCOUNTERS;
+        iftCSV *csv = iftCreateCSV(nrows, 3);
+        int r = 0;
+
+        strcpy(csv->data[r][0], "type");
+        strcpy(csv->data[r][1], "name");
+        strcpy(csv->data[r][2], "value");
+        r++;
+        for (int s = 0; s < IFT_RADON_NSTAGES; s++, r++) {
+            strcpy(csv->data[r][0], "stage");
+            strcpy(csv->data[r][1], ift_radon_stage_name[s]);
+            sprintf(csv->data[r][2], "%.3f", ift_radon_stage_time[s] * 1000.0);
+        }
+        if (ift_radon_stats_verbosity >= 2)
+            for (int s = 0; s < IFT_RADON_NSTAGES; s++, r++) {
+                strcpy(csv->data[r][0], "calls");
+                strcpy(csv->data[r][1], ift_radon_stage_name[s]);
+                sprintf(csv->data[r][2], "%ld", ift_radon_stage_calls[s]);
+            }
+        for (int c = 0; c < IFT_RADON_NCOUNTERS; c++, r++) {
+            strcpy(csv->data[r][0], "counter");
+            strcpy(csv->data[r][1], ift_radon_counter_name[c]);
+            sprintf(csv->data[r][2], "%ld", ift_radon_counter[c]);
+        }
+
+        iftWriteCSV(csv, path, ',');
+        iftDestroyCSV(&csv);
+    } else
+        iftError("Invalid statistics file: %s (it must be .json or .csv)", "iftWriteRadonStats", path);
+}
+
+
+void iftParseRadonStatsOptions(int *argc, char *argv[])
+{
+    int n = 1, verbosity = 0;
+    bool verbosity_given = false;
+
+    for (int i = 1; i < *argc; i++) {
+        if ((strcmp(argv[i], "-v") == 0) && (i + 1 < *argc)) {
+            verbosity       = atoi(argv[++i]);
+            verbosity_given = true;
+        }
+        else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < *argc))
+            ift_radon_stats_path = argv[++i];
+        else
+            argv[n++] = argv[i];
+    }
+    *argc = n;
+
+    /* resolved once all the options are known, so their order does not matter */
+    if (verbosity_given)
+        iftSetRadonStatsVerbosity(verbosity);
+    else if ((ift_radon_stats_path != NULL) && (ift_radon_stats_verbosity == 0))
+        iftSetRadonStatsVerbosity(1);
+}
+
+
+void iftFinishRadonStats(void)
+{
+    if (ift_radon_stats_verbosity == 0)
+        return;
+
+    if (ift_radon_stats_path != NULL)
+        iftWriteRadonStats(ift_radon_stats_path);
+    else {
+        iftJson *json = iftRadonStatsToJson();
+        iftPrintJson(json);
+        iftDestroyJson(&json);
+    }
+}
@@ -0,0 +1,172 @@
+#include <pthread.h>
+#include "iftRadonWriter.h"
+#include "iftRadonColormap.h"
+#include "iftRadonStats.h"
+
+
+typedef struct {
+    /* either an image or an RGB buffer */
+    iftImage *img;
+    uchar *rgb;
+    int xsize, ysize;
+    char *path;
+} iftRadonWriterJob;
+
+struct ift_radon_writer {
+    bool visualization;
+    int nthreads;
+    pthread_t *threads;
+
+    /* circular queue */
+    iftRadonWriterJob *jobs;
+    int capacity, first, njobs;
+    bool closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty, not_full;
+};
+
+
+static void iftRadonWriterRun(iftRadonWriterJob *job)
+{
+    double tic = iftRadonStatsTic();
+    if (job->img != NULL) {
+        iftWriteImageByExt(job->img, job->path);
+        iftDestroyImage(&job->img);
+    } else {
+        iftRadonWriteRGBPNG(job->rgb, job->xsize, job->ysize, job->path);
+        iftFree(job->rgb);
+    }
+    iftFree(job->path);
+    iftRadonStatsToc(IFT_RADON_STAGE_ENCODE, tic);
+}
+
+
+static void *iftRadonWriterThread(void *arg)
+{
+    iftRadonWriter *writer = (iftRadonWriter *) arg;
+
+    while (true) {
+        pthread_mutex_lock(&writer->lock);
+        while ((writer->njobs == 0) && !writer->closed)
+            pthread_cond_wait(&writer->not_empty, &writer->lock);
+        if (writer->njobs == 0) {
+            /* closed and drained */
+            pthread_mutex_unlock(&writer->lock);
+            return NULL;
+        }
+        iftRadonWriterJob job = writer->jobs[writer->first];
+        writer->first = (writer->first + 1) % writer->capacity;
+        writer->njobs--;
+        pthread_cond_signal(&writer->not_full);
+        pthread_mutex_unlock(&writer->lock);
+
+        iftRadonWriterRun(&job);
+    }
+}
+
+
+static void iftRadonWriterPush(iftRadonWriter *writer, iftRadonWriterJob job)
+{
+    if (writer->nthreads == 0) {
+        iftRadonWriterRun(&job);
+        return;
+    }
+
+    pthread_mutex_lock(&writer->lock);
+    while (writer->njobs == writer->capacity)
+        pthread_cond_wait(&writer->not_full, &writer->lock);
+    writer->jobs[(writer->first + writer->njobs) % writer->capacity] = job;
+    writer->njobs++;
+    pthread_cond_signal(&writer->not_empty);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+
+iftRadonWriter *iftCreateRadonWriter(int nthreads, int capacity, bool visualization)
+{
+    if (nthreads < 0)
+        iftError("Invalid number of encoder threads: %d", "iftCreateRadonWriter", nthreads);
+    if (capacity <= 0)
+        iftError("Invalid queue capacity: %d", "iftCreateRadonWriter", capacity);
+
+    iftRadonWriter *writer = (iftRadonWriter *) iftAlloc(1, sizeof(iftRadonWriter));
+    writer->visualization = visualization;
+    writer->nthreads      = nthreads;
+    writer->capacity      = capacity;
+    writer->jobs          = (iftRadonWriterJob *) iftAlloc(capacity, sizeof(iftRadonWriterJob));
+    writer->threads       = (pthread_t *) iftAlloc(iftMax(nthreads, 1), sizeof(pthread_t));
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->not_empty, NULL);
+    pthread_cond_init(&writer->not_full, NULL);
+
+    for (int t = 0; t < nthreads; t++)
+        if (pthread_create(&writer->threads[t], NULL, iftRadonWriterThread, writer) != 0)
+            iftError("Cannot start the encoder threads", "iftCreateRadonWriter");
+
+    return writer;
+}
+
+
+void iftDestroyRadonWriter(iftRadonWriter **writer)
+{
+    if (writer == NULL || *writer == NULL)
+        return;
+
+    iftRadonWriter *w = *writer;
+    pthread_mutex_lock(&w->lock);
+    w->closed = true;
+    pthread_cond_broadcast(&w->not_empty);
+    pthread_mutex_unlock(&w->lock);
+    for (int t = 0; t < w->nthreads; t++)
+        pthread_join(w->threads[t], NULL);
+
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->not_empty);
+    pthread_cond_destroy(&w->not_full);
+    iftFree(w->jobs);
+    iftFree(w->threads);
+    iftFree(w);
+    *writer = NULL;
+}
+
+
+bool iftRadonWriterVisualization(const iftRadonWriter *writer)
+{
+    return writer->visualization;
+}
+
+
+void iftRadonWriterPushImage(iftRadonWriter *writer, iftImage *img, const char *path)
+{
+    iftRadonWriterJob job = {.img = img, .rgb = NULL, .path = iftCopyString(path)};
+    iftRadonWriterPush(writer, job);
+}
+
+
+void iftRadonWriterPushRGB(iftRadonWriter *writer, uchar *rgb, int xsize, int ysize, const char *path)
+{
+    iftRadonWriterJob job = {.img = NULL, .rgb = rgb, .xsize = xsize, .ysize = ysize, .path = iftCopyString(path)};
+    iftRadonWriterPush(writer, job);
+}
+
+
+iftRadonWriter *iftParseRadonWriterOptions(int *argc, char *argv[])
+{
+    int nthreads = IFT_RADON_WRITER_THREADS, capacity = IFT_RADON_WRITER_CAPACITY;
+    bool visualization = true;
+    int n = 1;
+
+    for (int i = 1; i < *argc; i++) {
+        if ((strcmp(argv[i], "-j") == 0) && (i + 1 < *argc))
+            nthreads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-q") == 0) && (i + 1 < *argc))
+            capacity = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-n") == 0)
+            visualization = false;
+        else
+            argv[n++] = argv[i];
+    }
+    *argc = n;
+
+    return iftCreateRadonWriter(nthreads, capacity, visualization);
+}
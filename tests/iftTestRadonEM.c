@@ -0,0 +1,118 @@
+#include "ift.h"
+#include "iftRadon.h"
+#include "iftRadonEM.h"
+
+/*
+ * Regression check of the projectors of the EM reconstructions: the back-projector must be the transpose of the
+ * forward projector (<A x, y> = <x, A^T y> for random x and y), the forward projections of 8-bit images must be
+ * the sinograms of iftFastRadonTransform(), and the back-projection by bands of rows must not depend on the
+ * number of threads.
+ */
+
+/* relative tolerance of the inner products, whose terms are summed in float by the projectors */
+#define IFT_TEST_EM_TOLERANCE 1e-5
+
+
+/* deterministic values in [0, 1) */
+static float iftTestRandom(unsigned int *state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return ((*state >> 8) & 0xFFFF) / 65536.0f;
+}
+
+
+static double iftTestInnerProduct(const iftFImage *a, const iftFImage *b)
+{
+    double sum = 0;
+
+    for (int p = 0; p < a->n; p++)
+        sum += (double) a->val[p] * b->val[p];
+
+    return sum;
+}
+
+
+static int iftTestRadonEMProjectors(int xsize, int ysize)
+{
+    int nfails = 0;
+    unsigned int state = xsize * 7919 + ysize;
+    int nthreads = omp_get_max_threads();
+
+    omp_set_num_threads(1);
+    iftRadonEM *em1 = iftCreateRadonEM(xsize, ysize, 1);
+    omp_set_num_threads(3);
+    iftRadonEM *em3 = iftCreateRadonEM(xsize, ysize, 1);
+    omp_set_num_threads(nthreads);
+
+    /* adjointness */
+    iftFImage *x = iftCreateFImage(xsize, ysize, 1);
+    for (int p = 0; p < x->n; p++)
+        x->val[p] = iftTestRandom(&state);
+    iftFImage *Ax = iftRadonEMForwardProjection(em3, x);
+    iftFImage *y = iftCreateFImage(Ax->xsize, Ax->ysize, 1);
+    for (int p = 0; p < y->n; p++)
+        y->val[p] = iftTestRandom(&state);
+    iftFImage *ATy = iftRadonEMBackProjection(em3, y);
+
+    double lhs = iftTestInnerProduct(Ax, y), rhs = iftTestInnerProduct(x, ATy);
+    double err = fabs(lhs - rhs) / iftMax(fabs(lhs), 1e-30);
+    if (err > IFT_TEST_EM_TOLERANCE) {
+        printf("%dx%d: <Ax, y> = %.8g but <x, A^T y> = %.8g\n", xsize, ysize, lhs, rhs);
+        nfails++;
+    }
+
+    /* the bands of rows of 1 and 3 threads */
+    iftFImage *ATy1 = iftRadonEMBackProjection(em1, y);
+    for (int p = 0; p < x->n; p++)
+        if (ATy1->val[p] != ATy->val[p]) {
+            printf("%dx%d: pixel (%d, %d) of A^T y is %.8g with 1 thread and %.8g with 3\n", xsize, ysize,
+                   p % xsize, p / xsize, ATy1->val[p], ATy->val[p]);
+            nfails++;
+            break;
+        }
+
+    /* the forward projector of an 8-bit image is the fast transform, unless the latter steps in float */
+#ifndef IFT_RADON_REFERENCE_KERNEL
+    iftImage *img = iftCreateImage(xsize, ysize, 1);
+    for (int p = 0; p < img->n; p++) {
+        img->val[p] = (int) (256 * iftTestRandom(&state));
+        x->val[p] = img->val[p];
+    }
+    iftImage *R = iftFastRadonTransform(img);
+    iftFImage *Ay = iftRadonEMForwardProjection(em1, x);
+    for (int p = 0; p < R->n; p++)
+        if (Ay->val[p] != R->val[p]) {
+            printf("%dx%d: bin (theta %d, rho %d) is %.8g instead of %d\n", xsize, ysize, p % R->xsize,
+                   p / R->xsize, Ay->val[p], R->val[p]);
+            nfails++;
+            break;
+        }
+    iftDestroyImage(&img);
+    iftDestroyImage(&R);
+    iftDestroyFImage(&Ay);
+#endif
+
+    printf("%4dx%-4d %s (adjointness error %.2e)\n", xsize, ysize, (nfails == 0) ? "ok" : "FAILED", err);
+
+    iftDestroyFImage(&x);
+    iftDestroyFImage(&y);
+    iftDestroyFImage(&Ax);
+    iftDestroyFImage(&ATy);
+    iftDestroyFImage(&ATy1);
+    iftDestroyRadonEM(&em1);
+    iftDestroyRadonEM(&em3);
+
+    return nfails;
+}
+
+
+int main(void)
+{
+    int nfails = 0;
+    int sizes[][2] = {{1, 1}, {3, 2}, {7, 9}, {17, 5}, {64, 64}, {113, 97}, {200, 31}, {317, 229}};
+
+    for (int k = 0; k < 8; k++)
+        nfails += iftTestRadonEMProjectors(sizes[k][0], sizes[k][1]);
+
+    return (nfails == 0) ? 0 : 1;
+}
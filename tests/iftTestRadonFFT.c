@@ -0,0 +1,199 @@
+#include "ift.h"
+#include "iftRadonFFT.h"
+
+/*
+ * Regression check of the FFT of the Radon module against the direct DFT, computed in long double: the complex
+ * and real transforms of lengths with every kind of radix (4, 2, 3, 5 and other primes), batched over several
+ * interleaved sequences, their inverses, and the ramp filtering of a sinogram against the direct convolution.
+ */
+
+/* relative tolerance of the transforms, with respect to the largest coefficient */
+#define IFT_TEST_FFT_TOLERANCE 1e-12
+
+
+/* deterministic values in [-1, 1) */
+static double iftTestRandom(unsigned int *state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return ((*state >> 8) & 0xFFFF) / 32768.0 - 1.0;
+}
+
+
+/* cos and sin of 2 pi m / n, m = 0..n-1, for the direct DFT */
+static void iftTestTwiddles(int n, long double **c, long double **s)
+{
+    *c = (long double *) iftAlloc(n, sizeof(long double));
+    *s = (long double *) iftAlloc(n, sizeof(long double));
+    for (int m = 0; m < n; m++) {
+        (*c)[m] = cosl(2 * (long double) IFT_PI * m / n);
+        (*s)[m] = sinl(2 * (long double) IFT_PI * m / n);
+    }
+}
+
+
+/* direct DFT of the sequence b of howmany interleaved ones: the coefficient k */
+static void iftTestDFT(const double *re, const double *im, int n, int howmany, int b, int k, int sign,
+                       const long double *c, const long double *s, long double *Xr, long double *Xi)
+{
+    long double sr = 0, si = 0;
+
+    for (int j = 0; j < n; j++) {
+        int m = (int) (((long) j * k) % n);
+        long double xr = re[(size_t) j * howmany + b], xi = (im != NULL) ? im[(size_t) j * howmany + b] : 0;
+        sr += xr * c[m] - xi * sign * s[m];
+        si += xr * sign * s[m] + xi * c[m];
+    }
+    *Xr = sr;
+    *Xi = si;
+}
+
+
+static int iftTestComplexFFT(int n, int howmany)
+{
+    size_t size = (size_t) n * howmany;
+    double *re = iftAllocDoubleArray(size), *im = iftAllocDoubleArray(size);
+    double *xr = iftAllocDoubleArray(size), *xi = iftAllocDoubleArray(size);
+    unsigned int state = n;
+    for (size_t i = 0; i < size; i++) {
+        re[i] = xr[i] = iftTestRandom(&state);
+        im[i] = xi[i] = iftTestRandom(&state);
+    }
+
+    long double *c, *s;
+    iftTestTwiddles(n, &c, &s);
+    iftRadonFFT *fft = iftCreateRadonFFT(n);
+    double err = 0, scale = 1e-300;
+    for (int sign = IFT_RADON_FFT_FORWARD; sign <= IFT_RADON_FFT_INVERSE; sign += 2) {
+        memcpy(re, xr, size * sizeof(double));
+        memcpy(im, xi, size * sizeof(double));
+        iftExecuteRadonFFT(fft, re, im, howmany, sign);
+        for (int b = 0; b < howmany; b++)
+            for (int k = 0; k < n; k++) {
+                long double Xr, Xi;
+                iftTestDFT(xr, xi, n, howmany, b, k, sign, c, s, &Xr, &Xi);
+                size_t i = (size_t) k * howmany + b;
+                err   = iftMax(err, (double) fabsl(re[i] - Xr) + fabsl(im[i] - Xi));
+                scale = iftMax(scale, (double) fabsl(Xr) + fabsl(Xi));
+            }
+    }
+
+    /* inverse of the forward transform: n times the input */
+    memcpy(re, xr, size * sizeof(double));
+    memcpy(im, xi, size * sizeof(double));
+    iftExecuteRadonFFT(fft, re, im, howmany, IFT_RADON_FFT_FORWARD);
+    iftExecuteRadonFFT(fft, re, im, howmany, IFT_RADON_FFT_INVERSE);
+    for (size_t i = 0; i < size; i++)
+        err = iftMax(err, fabs(re[i] / n - xr[i]) + fabs(im[i] / n - xi[i]));
+    iftDestroyRadonFFT(&fft);
+
+    iftFree(c);
+    iftFree(s);
+    iftFree(re);
+    iftFree(im);
+    iftFree(xr);
+    iftFree(xi);
+
+    bool ok = (err <= IFT_TEST_FFT_TOLERANCE * scale);
+    printf("complex FFT, n = %4d, %3d sequences   %s (error %.2e)\n", n, howmany, ok ? "ok" : "FAILED", err / scale);
+
+    return ok ? 0 : 1;
+}
+
+
+static int iftTestRealFFT(int n, int howmany)
+{
+    size_t size = (size_t) n * howmany, nc = (size_t) (n / 2 + 1) * howmany;
+    double *x = iftAllocDoubleArray(size), *out = iftAllocDoubleArray(size);
+    double *re = iftAllocDoubleArray(nc), *im = iftAllocDoubleArray(nc);
+    unsigned int state = 7 * n;
+    for (size_t i = 0; i < size; i++)
+        x[i] = iftTestRandom(&state);
+
+    long double *c, *s;
+    iftTestTwiddles(n, &c, &s);
+    iftRadonFFT *fft = iftCreateRadonFFT(n);
+    iftExecuteRadonRealFFT(fft, x, re, im, howmany);
+    double err = 0, scale = 1e-300;
+    for (int b = 0; b < howmany; b++)
+        for (int k = 0; k <= n / 2; k++) {
+            long double Xr, Xi;
+            iftTestDFT(x, NULL, n, howmany, b, k, IFT_RADON_FFT_FORWARD, c, s, &Xr, &Xi);
+            size_t i = (size_t) k * howmany + b;
+            err   = iftMax(err, (double) fabsl(re[i] - Xr) + fabsl(im[i] - Xi));
+            scale = iftMax(scale, (double) fabsl(Xr) + fabsl(Xi));
+        }
+
+    iftExecuteRadonInverseRealFFT(fft, re, im, out, howmany);
+    for (size_t i = 0; i < size; i++)
+        err = iftMax(err, fabs(out[i] / n - x[i]));
+    iftDestroyRadonFFT(&fft);
+
+    iftFree(c);
+    iftFree(s);
+    iftFree(x);
+    iftFree(out);
+    iftFree(re);
+    iftFree(im);
+
+    bool ok = (err <= IFT_TEST_FFT_TOLERANCE * scale);
+    printf("real FFT,    n = %4d, %3d sequences   %s (error %.2e)\n", n, howmany, ok ? "ok" : "FAILED", err / scale);
+
+    return ok ? 0 : 1;
+}
+
+
+/* ramp filtering of a sinogram against the direct convolution of its columns with the band-limited ramp */
+static int iftTestRampFilter(int nbins)
+{
+    iftImage *R = iftCreateImage(IFT_RADON_NANGLES, nbins, 1);
+    unsigned int state = nbins;
+    for (int p = 0; p < R->n; p++)
+        R->val[p] = (int) (1000 * (iftTestRandom(&state) + 1));
+
+    iftFImage *Q = iftRadonRampFilter(R);
+    double err = 0, scale = 1e-300;
+    for (int theta = 0; theta < IFT_RADON_NANGLES; theta++)
+        for (int rho = 0; rho < nbins; rho++) {
+            long double q = 0;
+            for (int j = 0; j < nbins; j++) {
+                int k = abs(rho - j);
+                long double h = (k == 0) ? 0.25L : (k % 2 == 1) ? -1.0L / ((long double) IFT_PI * IFT_PI * k * k) : 0;
+                q += h * iftImgVal2D(R, theta, j);
+            }
+            err   = iftMax(err, (double) fabsl(iftImgVal2D(Q, theta, rho) - q));
+            scale = iftMax(scale, (double) fabsl(q));
+        }
+    iftDestroyFImage(&Q);
+    iftDestroyImage(&R);
+
+    /* the filtered sinogram is stored in float */
+    bool ok = (err <= 1e-6 * scale);
+    printf("ramp filter, %4d bins                  %s (error %.2e)\n", nbins, ok ? "ok" : "FAILED", err / scale);
+
+    return ok ? 0 : 1;
+}
+
+
+int main(void)
+{
+    int nfails = 0;
+    int lengths[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 15, 16, 25, 30, 49, 60, 64, 97, 120, 180, 210, 256, 289, 360,
+                     1000, 1024};
+    int nlengths = sizeof(lengths) / sizeof(lengths[0]);
+    int howmany[] = {1, 3, IFT_RADON_NANGLES};
+
+    for (int i = 0; i < nlengths; i++)
+        for (int j = 0; j < 3; j++) {
+            /* the direct DFT costs n^2 per sequence */
+            if ((long) lengths[i] * lengths[i] * howmany[j] > 4000000)
+                continue;
+            nfails += iftTestComplexFFT(lengths[i], howmany[j]);
+            nfails += iftTestRealFFT(lengths[i], howmany[j]);
+        }
+
+    int nbins[] = {1, 2, 5, 64, 393};
+    for (int i = 0; i < 5; i++)
+        nfails += iftTestRampFilter(nbins[i]);
+
+    return (nfails == 0) ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ift.h"
+#include "iftRadon.h"
+#include "iftRadonPlan.h"
+
+/*
+ * Regression check of the plan cache: a plan saved to the cache and mapped back must give the sinograms of
+ * iftFastRadonTransform() through every entry point, a valid file must be mapped instead of rewritten, and
+ * corrupted or truncated files must be ignored and replaced.
+ *
+ * Whether a call replaced the file is told by a hard link to the file kept before the call: the link keeps the
+ * old inode alive, so the file has the inode of the link only when it was mapped.
+ */
+
+
+/* the sinograms of every entry point of the plan must be the reference */
+static int iftTestPlanExecutions(const char *name, const iftRadonPlan *plan, const iftImage *img,
+                                 const iftImage *ref)
+{
+    if ((iftRadonPlanNumberOfBins(plan) != ref->ysize) || (iftRadonPlanOutputSize(plan) != (size_t) ref->n)) {
+        printf("%s: %d bins instead of %d\n", name, iftRadonPlanNumberOfBins(plan), ref->ysize);
+        return 1;
+    }
+
+    int nfails = 0;
+    int *out[2] = {iftAllocIntArray(ref->n), iftAllocIntArray(ref->n)};
+    uchar *u8 = iftAllocUCharArray(img->n);
+    ushort *u16 = iftAllocUShortArray(img->n);
+    for (int p = 0; p < img->n; p++) {
+        u8[p] = img->val[p];
+        u16[p] = img->val[p];
+    }
+    const int *in[2] = {img->val, img->val};
+
+    for (int e = 0; e < 4; e++) {
+        const char *entry[4] = {"int32", "uint8", "uint16", "batch"};
+        if (e == 0)
+            iftExecuteRadonPlan(plan, img->val, out[0]);
+        else if (e == 1)
+            iftExecuteRadonPlanU8(plan, u8, out[0]);
+        else if (e == 2)
+            iftExecuteRadonPlanU16(plan, u16, out[0]);
+        else
+            iftExecuteRadonPlanBatch(plan, in, 2, out);
+
+        for (int p = 0; p < ref->n; p++)
+            if ((out[0][p] != ref->val[p]) || ((e == 3) && (out[1][p] != ref->val[p]))) {
+                printf("%s (%s): bin (theta %d, rho %d) differs from the fast transform\n", name, entry[e],
+                       p % ref->xsize, p / ref->xsize);
+                nfails++;
+                break;
+            }
+    }
+
+    iftFree(out[0]);
+    iftFree(out[1]);
+    iftFree(u8);
+    iftFree(u16);
+
+    return nfails;
+}
+
+
+/* path of the only file of the cache directory, or NULL */
+static char *iftTestCacheFile(const char *dir)
+{
+    DIR *dp = opendir(dir);
+    if (dp == NULL)
+        return NULL;
+
+    char *path = NULL;
+    int nfiles = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dp)) != NULL) {
+        if (entry->d_name[0] == '.')
+            continue;
+        nfiles++;
+        iftFree(path);
+        path = iftAllocCharArray(strlen(dir) + strlen(entry->d_name) + 2);
+        sprintf(path, "%s/%s", dir, entry->d_name);
+    }
+    closedir(dp);
+
+    if (nfiles != 1) {
+        iftFree(path);
+        return NULL;
+    }
+
+    return path;
+}
+
+
+static bool iftTestSameInode(const char *path1, const char *path2)
+{
+    struct stat st1, st2;
+    return (stat(path1, &st1) == 0) && (stat(path2, &st2) == 0) && (st1.st_ino == st2.st_ino);
+}
+
+
+/* damages the cache file: 0 overwrites its header, 1 fills a block of its rays with 0xFF, 2 truncates it */
+static void iftTestDamageFile(const char *path, int damage)
+{
+    struct stat st;
+    stat(path, &st);
+    FILE *fp = fopen(path, "r+b");
+
+    if (damage == 2) {
+        if (ftruncate(fileno(fp), st.st_size / 2) != 0)
+            printf("%s: cannot truncate\n", path);
+    } else {
+        char block[256];
+        memset(block, (damage == 0) ? 0x5A : 0xFF, sizeof(block));
+        /* the header is at the start and the rays, which fill most of the file, follow it */
+        fseek(fp, (damage == 0) ? 0 : st.st_size / 3, SEEK_SET);
+        fwrite(block, 1, iftMin(sizeof(block), (size_t) st.st_size / 3), fp);
+    }
+
+    fclose(fp);
+}
+
+
+static int iftTestRadonPlanCache(const char *tmpdir, int xsize, int ysize)
+{
+    char name[64], dir[512], keep[512];
+    sprintf(name, "%dx%d", xsize, ysize);
+    sprintf(dir, "%s/cache_%s", tmpdir, name);
+    sprintf(keep, "%s/keep_%s", tmpdir, name);
+
+    iftImage *img = iftCreateImage(xsize, ysize, 1);
+    for (int p = 0; p < img->n; p++)
+        img->val[p] = (p * 37) % 200;
+    iftImage *ref = iftFastRadonTransform(img);
+    int nfails = 0;
+
+    /* the first call computes the plan and saves it, creating the directory */
+    iftRadonPlan *plan = iftCreateCachedRadonPlan(dir, xsize, ysize);
+    nfails += iftTestPlanExecutions(name, plan, img, ref);
+    iftDestroyRadonPlan(&plan);
+    char *path = iftTestCacheFile(dir);
+    if (path == NULL) {
+        printf("%s: the plan was not saved to %s\n", name, dir);
+        iftDestroyImage(&img);
+        iftDestroyImage(&ref);
+        return nfails + 1;
+    }
+
+    /* the second call maps it */
+    link(path, keep);
+    plan = iftCreateCachedRadonPlan(dir, xsize, ysize);
+    nfails += iftTestPlanExecutions(name, plan, img, ref);
+    iftDestroyRadonPlan(&plan);
+    if (!iftTestSameInode(path, keep)) {
+        printf("%s: a valid plan file was rewritten\n", name);
+        nfails++;
+    }
+    unlink(keep);
+
+    /* damaged files are replaced, and the new file is mapped by the next call */
+    const char *damages[3] = {"header", "rays", "truncated"};
+    for (int damage = 0; damage < 3; damage++) {
+        char label[128];
+        sprintf(label, "%s, %s file", name, damages[damage]);
+        iftTestDamageFile(path, damage);
+        link(path, keep);
+
+        plan = iftCreateCachedRadonPlan(dir, xsize, ysize);
+        nfails += iftTestPlanExecutions(label, plan, img, ref);
+        iftDestroyRadonPlan(&plan);
+        if (iftTestSameInode(path, keep)) {
+            printf("%s: the damaged file was not replaced\n", label);
+            nfails++;
+        }
+        unlink(keep);
+
+        link(path, keep);
+        plan = iftCreateCachedRadonPlan(dir, xsize, ysize);
+        nfails += iftTestPlanExecutions(label, plan, img, ref);
+        iftDestroyRadonPlan(&plan);
+        if (!iftTestSameInode(path, keep)) {
+            printf("%s: the replaced file was not mapped\n", label);
+            nfails++;
+        }
+        unlink(keep);
+    }
+
+    unlink(path);
+    rmdir(dir);
+    iftFree(path);
+    iftDestroyImage(&img);
+    iftDestroyImage(&ref);
+    printf("%-10s %s\n", name, (nfails == 0) ? "ok" : "FAILED");
+
+    return nfails;
+}
+
+
+/* a cache that cannot be created costs the computation only, and missing parents are created */
+static int iftTestRadonPlanCacheDirs(const char *tmpdir)
+{
+    int nfails = 0;
+    char file[512], dirs[2][512], nested[512];
+    sprintf(file, "%s/file", tmpdir);
+    sprintf(dirs[0], "%s/file/cache", tmpdir);
+    sprintf(dirs[1], "%s/a/b/cache", tmpdir);
+    fclose(fopen(file, "w"));
+
+    iftImage *img = iftCreateImage(31, 17, 1);
+    for (int p = 0; p < img->n; p++)
+        img->val[p] = (p * 37) % 200;
+    iftImage *ref = iftFastRadonTransform(img);
+
+    for (int i = 0; i < 2; i++) {
+        iftRadonPlan *plan = iftCreateCachedRadonPlan(dirs[i], img->xsize, img->ysize);
+        nfails += iftTestPlanExecutions(dirs[i], plan, img, ref);
+        iftDestroyRadonPlan(&plan);
+    }
+    char *path = iftTestCacheFile(dirs[1]);
+    if (path == NULL) {
+        printf("%s: the plan was not saved\n", dirs[1]);
+        nfails++;
+    } else
+        unlink(path);
+    iftFree(path);
+
+    rmdir(dirs[1]);
+    sprintf(nested, "%s/a/b", tmpdir);
+    rmdir(nested);
+    sprintf(nested, "%s/a", tmpdir);
+    rmdir(nested);
+    unlink(file);
+    iftDestroyImage(&img);
+    iftDestroyImage(&ref);
+    printf("%-10s %s\n", "cache dirs", (nfails == 0) ? "ok" : "FAILED");
+
+    return nfails;
+}
+
+
+int main(void)
+{
+    char tmpdir[] = "/tmp/iftTestRadonPlanXXXXXX";
+    if (mkdtemp(tmpdir) == NULL)
+        iftError("Cannot create a temporary directory", "main");
+
+    int nfails = 0;
+    int sizes[][2] = {{1, 1}, {7, 9}, {97, 61}, {200, 31}, {317, 229}};
+    for (int k = 0; k < 5; k++)
+        nfails += iftTestRadonPlanCache(tmpdir, sizes[k][0], sizes[k][1]);
+    nfails += iftTestRadonPlanCacheDirs(tmpdir);
+    rmdir(tmpdir);
+
+    return (nfails == 0) ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+#include "ift.h"
+#include "iftRadon.h"
+#include "iftRadonPlan.h"
+
+/*
+ * Regression check of the fast projectors: the sinograms of iftFastRadonTransform(), of its tiles and of the
+ * plans (both schedules) must be equal, bin by bin, to those of the baseline projector, which traces the ray of
+ * each bin (iftRadonRayEndpoints()) by the scalar DDA of the first iftFastRadonTransform2D, with the Q16.16
+ * stepping of the kernels for the images that use it. The sinograms updated by iftUpdateFastRadonTransform()
+ * must be those of the fast transform of the new image, the oversampled transform with one sub-ray per bin must
+ * be the fast transform, and the oversampled sinograms of a constant image must not depend on the sub-rays.
+ */
+
+/* largest image side traced in Q16.16 by the kernels */
+#define IFT_TEST_Q16_MAX_SIDE 32767
+
+
+/* baseline projector */
+
+static int iftTestSign(int x)
+{
+    return (x >= 0) ? 1 : -1;
+}
+
+
+/* sum of the pixels from p1 to pn (pn excluded) in float positions */
+static int iftTestDDA(const iftImage *img, iftVoxel p1, iftVoxel pn)
+{
+    int n = 1;
+    float px, py, J = 0, dx = 0, dy = 0;
+
+    if (p1.x != pn.x || p1.y != pn.y) {
+        int Dx = pn.x - p1.x, Dy = pn.y - p1.y;
+        if (abs(Dx) >= abs(Dy)) {
+            n  = abs(Dx) + 1;
+            dx = iftTestSign(Dx);
+            dy = (dx * Dy) / Dx;
+        } else {
+            n  = abs(Dy) + 1;
+            dy = iftTestSign(Dy);
+            dx = (dy * Dx) / Dy;
+        }
+    }
+
+    px = p1.x;
+    py = p1.y;
+    for (int k = 1; k < n; k++) {
+        J += iftImgVal2D(img, (int) px, (int) py);
+        px += dx;
+        py += dy;
+    }
+
+    return (int) J;
+}
+
+
+/* same samples in Q16.16 positions, the minor-axis increment truncated toward zero */
+static int iftTestFixedDDA(const iftImage *img, iftVoxel p1, iftVoxel pn)
+{
+    int n = 1;
+    int64_t J = 0;
+    int32_t px, py, dx = 0, dy = 0;
+
+    if (p1.x != pn.x || p1.y != pn.y) {
+        int Dx = pn.x - p1.x, Dy = pn.y - p1.y;
+        if (abs(Dx) >= abs(Dy)) {
+            n  = abs(Dx) + 1;
+            dx = iftTestSign(Dx) * 65536;
+            dy = (int32_t) (((int64_t) Dy * 65536) / abs(Dx));
+        } else {
+            n  = abs(Dy) + 1;
+            dy = iftTestSign(Dy) * 65536;
+            dx = (int32_t) (((int64_t) Dx * 65536) / abs(Dy));
+        }
+    }
+
+    px = p1.x * 65536;
+    py = p1.y * 65536;
+    for (int k = 1; k < n; k++) {
+        J += iftImgVal2D(img, px >> 16, py >> 16);
+        px += dx;
+        py += dy;
+    }
+
+    return (int) J;
+}
+
+
+static iftImage *iftTestBaselineRadonTransform(const iftImage *img)
+{
+#ifdef IFT_RADON_REFERENCE_KERNEL
+    bool fixed = false;
+#else
+    bool fixed = (img->xsize <= IFT_TEST_Q16_MAX_SIDE) && (img->ysize <= IFT_TEST_Q16_MAX_SIDE);
+#endif
+    iftImage *R = iftCreateImage(IFT_RADON_NANGLES, iftRadonNumberOfBins(img), 1);
+
+    for (int theta = 0; theta < R->xsize; theta++)
+        for (int rho = 0; rho < R->ysize; rho++) {
+            iftVoxel p1, pn;
+            if (!iftRadonRayEndpoints(img, theta, rho, &p1, &pn))
+                iftImgVal2D(R, theta, rho) = 0;
+            else if (p1.x == pn.x && p1.y == pn.y)
+                iftImgVal2D(R, theta, rho) = iftImgVal2D(img, p1.x, p1.y);
+            else
+                iftImgVal2D(R, theta, rho) = fixed ? iftTestFixedDDA(img, p1, pn) : iftTestDDA(img, p1, pn);
+        }
+
+    return R;
+}
+
+
+/* checks */
+
+static int iftTestCompare(const char *name, const int *val, const iftImage *ref)
+{
+    for (int p = 0; p < ref->n; p++)
+        if (val[p] != ref->val[p]) {
+            printf("%s: bin (theta %d, rho %d) is %d instead of %d\n", name, p % ref->xsize, p / ref->xsize,
+                   val[p], ref->val[p]);
+            return 1;
+        }
+    return 0;
+}
+
+
+/* the sinogram of img updated to images changed inside boxes, with values of every width, is the fast transform */
+static int iftTestRadonUpdate(const char *name, const iftImage *img)
+{
+    char label[256];
+    int nfails = 0;
+    iftImage *prev = iftCopyImage(img);
+    iftImage *R = iftFastRadonTransform(prev);
+
+    /* a few pixels, a box crossing the image border and the whole image, each changed to 8, 16 and 32-bit values */
+    int xs = img->xsize, ys = img->ysize;
+    iftBoundingBox boxes[3] = {
+        {.begin = {xs / 3, ys / 2, 0}, .end = {xs / 3 + 2, ys / 2 + 1, 0}},
+        {.begin = {-5, 2 * ys / 3, 0}, .end = {xs / 4, ys + 5, 0}},
+        {.begin = {0, 0, 0},           .end = {xs - 1, ys - 1, 0}}
+    };
+    int scales[3] = {1, 300, 100000};
+#ifdef IFT_RADON_REFERENCE_KERNEL
+    /* the float sums of the reference kernel are exact for 8-bit values only */
+    int nscales = 1;
+    for (int p = 0; p < img->n; p++)
+        if ((img->val[p] < 0) || (img->val[p] > 255))
+            nscales = 0;
+#else
+    int nscales = 3;
+#endif
+    for (int b = 0; b < 3; b++)
+        for (int s = 0; s < nscales; s++) {
+            iftImage *curr = iftCopyImage(prev);
+            for (int y = iftMax(boxes[b].begin.y, 0); y <= iftMin(boxes[b].end.y, ys - 1); y++)
+                for (int x = iftMax(boxes[b].begin.x, 0); x <= iftMin(boxes[b].end.x, xs - 1); x++)
+                    iftImgVal2D(curr, x, y) = ((x * 7 + y * 13 + b) % 200) * scales[s];
+
+            iftUpdateFastRadonTransform(R, prev, curr, boxes[b]);
+            iftImage *ref = iftFastRadonTransform(curr);
+            sprintf(label, "%s: update (box %d, values x %d)", name, b, scales[s]);
+            nfails += iftTestCompare(label, R->val, ref);
+            iftDestroyImage(&ref);
+
+            iftDestroyImage(&prev);
+            prev = curr;
+        }
+
+    iftDestroyImage(&prev);
+    iftDestroyImage(&R);
+
+    return nfails;
+}
+
+
+/* one sub-ray per bin is the fast transform, and the sub-rays of a constant image all sum the same */
+static int iftTestRadonOversampled(const char *name, const iftImage *img)
+{
+    char label[256];
+    int nfails = 0;
+
+#ifndef IFT_RADON_REFERENCE_KERNEL
+    iftImage *ref = iftFastRadonTransform(img);
+    iftImage *R = iftOversampledRadonTransform(img, 1);
+    sprintf(label, "%s: oversampled (1 sub-ray)", name);
+    nfails += iftTestCompare(label, R->val, ref);
+    iftDestroyImage(&R);
+    iftDestroyImage(&ref);
+#endif
+
+    iftImage *cte = iftCreateImage(img->xsize, img->ysize, 1);
+    iftSetImage(cte, 7);
+    iftImage *R1 = iftOversampledRadonTransform(cte, 1);
+    int nsubrays[4] = {2, 3, 5, IFT_RADON_MAX_SUBRAYS};
+    for (int i = 0; i < 4; i++) {
+        iftImage *R = iftOversampledRadonTransform(cte, nsubrays[i]);
+        sprintf(label, "%s: constant image (%d sub-rays)", name, nsubrays[i]);
+        nfails += iftTestCompare(label, R->val, R1);
+        iftDestroyImage(&R);
+    }
+    iftDestroyImage(&R1);
+    iftDestroyImage(&cte);
+
+    return nfails;
+}
+
+
+static int iftTestRadonProjectors(const char *name, const iftImage *img)
+{
+    char label[256];
+    int nfails = 0;
+    iftImage *ref = iftTestBaselineRadonTransform(img);
+
+    iftImage *R = iftFastRadonTransform(img);
+    sprintf(label, "%s: fast transform", name);
+    nfails += (R->xsize != ref->xsize || R->ysize != ref->ysize) ? 1 : iftTestCompare(label, R->val, ref);
+    iftDestroyImage(&R);
+
+    /* four overlapping tiles that cover the sinogram */
+    int nbins = ref->ysize;
+    iftBoundingBox tiles[4] = {
+        {.begin = {0, 0, 0},             .end = {100, nbins / 2, 0}},
+        {.begin = {90, 0, 0},            .end = {179, nbins / 2 + 1, 0}},
+        {.begin = {0, nbins / 2 - 1, 0}, .end = {60, nbins - 1, 0}},
+        {.begin = {61, nbins / 2, 0},    .end = {179, nbins - 1, 0}}
+    };
+    R = iftFastRadonTransformTiles(img, tiles, 4);
+    sprintf(label, "%s: tiles", name);
+    nfails += iftTestCompare(label, R->val, ref);
+    iftDestroyImage(&R);
+
+    iftRadonPlan *plan = iftCreateRadonPlan(img->xsize, img->ysize);
+    int *out = iftAllocIntArray(iftRadonPlanOutputSize(plan));
+    iftRadonSchedule schedules[2] = {IFT_RADON_SCHEDULE_STEALING, IFT_RADON_SCHEDULE_STATIC};
+    for (int s = 0; s < 2; s++) {
+        iftSetRadonPlanSchedule(plan, schedules[s]);
+        iftExecuteRadonPlan(plan, img->val, out);
+        sprintf(label, "%s: plan (schedule %d)", name, s);
+        nfails += iftTestCompare(label, out, ref);
+    }
+    if (iftRadonNarrowestPixelType(img) == IFT_RADON_UINT8) {
+        uchar *u8 = iftAllocUCharArray(img->n);
+        for (int p = 0; p < img->n; p++)
+            u8[p] = img->val[p];
+        iftExecuteRadonPlanU8(plan, u8, out);
+        sprintf(label, "%s: plan (uint8 input)", name);
+        nfails += iftTestCompare(label, out, ref);
+        iftFree(u8);
+    }
+    iftFree(out);
+    iftDestroyRadonPlan(&plan);
+
+    iftDestroyImage(&ref);
+    nfails += iftTestRadonUpdate(name, img);
+    nfails += iftTestRadonOversampled(name, img);
+    printf("%-40s %s\n", name, (nfails == 0) ? "ok" : "FAILED");
+
+    return nfails;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int nfails = 0;
+
+    /* the images of the arguments, e.g. imgs/tools.png */
+    for (int i = 1; i < argc; i++) {
+        iftImage *img = iftReadImageByExt(argv[i]);
+        nfails += iftTestRadonProjectors(argv[i], img);
+        iftDestroyImage(&img);
+    }
+
+    /* odd sizes, with 8, 16 and 32-bit values */
+    int sizes[][2] = {{1, 1}, {3, 2}, {7, 9}, {17, 5}, {64, 64}, {113, 97}, {200, 31}, {317, 229}};
+    int scales[3] = {1, 300, 100000};
+    for (int k = 0; k < 8; k++)
+        for (int b = 0; b < 3; b++) {
+            iftImage *img = iftCreateImage(sizes[k][0], sizes[k][1], 1);
+            for (int p = 0; p < img->n; p++)
+                img->val[p] = ((p * 37) % 200) * scales[b];
+            char name[64];
+            sprintf(name, "%dx%d, values x %d", img->xsize, img->ysize, scales[b]);
+            nfails += iftTestRadonProjectors(name, img);
+            iftDestroyImage(&img);
+        }
+
+    return (nfails == 0) ? 0 : 1;
+}